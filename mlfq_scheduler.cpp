@@ -6,30 +6,97 @@
 #include <string>
 #include <iomanip>
 #include <fstream>
-#include <map>
 #include <climits>
+#include <cmath>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <sstream>
+#include <memory>
+#include <random>
+#include <variant>
+#include <chrono>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
 
 using namespace std;
 
 // ==================== PROCESS STRUCTURE ====================
+// The I/O and CPU bursts of a process after its first CPU burst, alternating
+// and starting with I/O: {io1, cpu2, io2, cpu3, ...}. Most processes are
+// CPU-only and have none; that costs one pointer and no allocation.
+class BurstList {
+private:
+    unique_ptr<int[]> data;     // count, CPU total, I/O total, then the bursts
+    
+public:
+    BurstList() {}
+    
+    explicit BurstList(const vector<int>& bursts) {
+        if (bursts.empty()) return;
+        data.reset(new int[bursts.size() + 3]);
+        data[0] = bursts.size();
+        data[1] = 0;
+        data[2] = 0;
+        for (size_t i = 0; i < bursts.size(); i++) {
+            data[i % 2 ? 1 : 2] += bursts[i];
+            data[i + 3] = bursts[i];
+        }
+    }
+    
+    BurstList(const BurstList& other) {
+        *this = other;
+    }
+    BurstList(BurstList&&) = default;
+    BurstList& operator=(BurstList&&) = default;
+    
+    BurstList& operator=(const BurstList& other) {
+        if (this == &other) return *this;
+        data.reset();
+        if (other.data) {
+            data.reset(new int[other.data[0] + 3]);
+            copy(other.data.get(), other.data.get() + other.data[0] + 3, data.get());
+        }
+        return *this;
+    }
+    
+    int size() const { return data ? data[0] : 0; }
+    bool empty() const { return !data; }
+    int operator[](int i) const { return data[i + 3]; }
+    int cpu_total() const { return data ? data[1] : 0; }
+    int io_total() const { return data ? data[2] : 0; }
+};
+
 struct Process {
     int pid;
     int arrival;
-    int burst;
-    int remaining;
+    int burst;               // Total CPU time over all CPU bursts
+    int remaining;           // Left of the current CPU burst
+    int io_time;             // Total I/O time
     int initial_priority;    // Initial priority (0=highest)
     int priority;            // Current queue level
     int start_time;
     int completion;
     int time_in_current_quantum;
-    int time_in_queue;
+    int time_in_queue;       // Waiting time accumulated before the current enqueue
+    int enqueue_time;        // When the process last entered a ready queue (or blocked)
+    long long queue_pos;     // Position key within its ready queue (0 while not queued)
+    Process* prev;           // Ready-list links (see ReadyList)
+    Process* next;
+    int phase;               // Index into bursts of the next I/O burst
+    BurstList bursts;        // I/O and CPU bursts after the first CPU burst
     bool started;
 
     Process() {}
-    Process(int pid_, int a, int b, int init_prio = 0) {
+    Process(int pid_, int a, int b, int init_prio = 0, const BurstList& more = BurstList()) {
         pid = pid_; 
         arrival = a; 
-        burst = b;
+        burst = b + more.cpu_total();
+        io_time = more.io_total();
         initial_priority = init_prio;
         remaining = b; 
         priority = init_prio;  // Start at initial priority
@@ -37,21 +104,72 @@ struct Process {
         completion = -1;
         time_in_current_quantum = 0;
         time_in_queue = 0;
+        enqueue_time = 0;
+        queue_pos = 0;
+        prev = nullptr;
+        next = nullptr;
+        phase = 0;
+        bursts = more;
         started = false;
     }
     
-    Process(const Process& other) {
-        pid = other.pid;
-        arrival = other.arrival;
-        burst = other.burst;
-        initial_priority = other.initial_priority;
-        remaining = other.burst;
-        priority = other.initial_priority;  // Start at initial priority
-        start_time = -1;
-        completion = -1;
-        time_in_current_quantum = 0;
-        time_in_queue = 0;
-        started = false;
+    bool has_io() const { return !bursts.empty(); }
+};
+
+// ==================== READY LIST ====================
+// Intrusive FIFO linked through Process::prev/next. Every operation,
+// including removal from the middle, is O(1) and allocates nothing.
+struct ReadyList {
+    Process* head;
+    Process* tail;
+    
+    ReadyList() : head(nullptr), tail(nullptr) {}
+    
+    bool empty() const { return head == nullptr; }
+    Process* front() const { return head; }
+    
+    void push_back(Process* p) {
+        p->prev = tail;
+        p->next = nullptr;
+        if (tail != nullptr) tail->next = p;
+        else head = p;
+        tail = p;
+    }
+    
+    void push_front(Process* p) {
+        p->prev = nullptr;
+        p->next = head;
+        if (head != nullptr) head->prev = p;
+        else tail = p;
+        head = p;
+    }
+    
+    void remove(Process* p) {
+        if (p->prev != nullptr) p->prev->next = p->next;
+        else head = p->next;
+        if (p->next != nullptr) p->next->prev = p->prev;
+        else tail = p->prev;
+        p->prev = nullptr;
+        p->next = nullptr;
+    }
+    
+    Process* pop_front() {
+        Process* p = head;
+        remove(p);
+        return p;
+    }
+    
+    // Move all of other's processes to the back of this list
+    void append(ReadyList& other) {
+        if (other.empty()) return;
+        if (tail != nullptr) {
+            tail->next = other.head;
+            other.head->prev = tail;
+        } else {
+            head = other.head;
+        }
+        tail = other.tail;
+        other.head = other.tail = nullptr;
     }
 };
 
@@ -59,11 +177,520 @@ struct Process {
 struct ProcessOriginal {
     int pid;
     int arrival;
-    int burst;
+    int burst;              // First CPU burst
     int initial_priority;
+    BurstList bursts;       // Later I/O and CPU bursts, if any
+    
+    ProcessOriginal(int p, int a, int b, int prio = 0, const BurstList& more = BurstList()) 
+        : pid(p), arrival(a), burst(b), initial_priority(prio), bursts(more) {}
+};
+
+// ==================== TRACE PARSING ====================
+// Hand-rolled parsing of the process file format: a line with the number
+// of processes, then one "PID Arrival Burst InitialPriority" row per line,
+// optionally followed by "IO CPU" pairs: after its first CPU burst the
+// process blocks for IO time units, then needs another CPU burst, and so
+// on. Blank lines are skipped, rows past the declared count are ignored,
+// and errors name the offending line.
+
+enum LineResult { LINE_OK, LINE_BLANK, LINE_BAD };
+
+const char* const ROW_FORMAT = "expected PID Arrival Burst InitialPriority [IO CPU]...";
+
+// Scan exactly n integers from the line [p, end). With `rest` more may
+// follow; *rest is set to where they start.
+LineResult scan_ints(const char* p, const char* end, int* out, int n, const char** rest = nullptr) {
+    for (int i = 0; i < n; i++) {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+        if (p == end) return i == 0 ? LINE_BLANK : LINE_BAD;
+        
+        bool negative = (*p == '-');
+        if (*p == '-' || *p == '+') p++;
+        if (p == end || *p < '0' || *p > '9') return LINE_BAD;
+        
+        long long value = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            value = value * 10 + (*p - '0');
+            if (value > INT_MAX) return LINE_BAD;
+            p++;
+        }
+        out[i] = negative ? -(int)value : (int)value;
+    }
+    if (rest != nullptr) {
+        *rest = p;
+        return LINE_OK;
+    }
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+    return p == end ? LINE_OK : LINE_BAD;
+}
+
+// Scan a process row into f[0..3] and its "IO CPU" pairs into `bursts`.
+// The bursts after the first must be positive, and a process with I/O
+// must start with a CPU burst.
+LineResult scan_process(const char* p, const char* end, int* f, vector<int>& bursts) {
+    bursts.clear();
+    LineResult r = scan_ints(p, end, f, 4, &p);
+    if (r != LINE_OK) return r;
+    while (true) {
+        int value;
+        r = scan_ints(p, end, &value, 1, &p);
+        if (r == LINE_BLANK) break;
+        if (r == LINE_BAD || value <= 0) return LINE_BAD;
+        bursts.push_back(value);
+    }
+    if (bursts.size() % 2 != 0 || (!bursts.empty() && f[2] <= 0)) return LINE_BAD;
+    return LINE_OK;
+}
+
+string line_error(long long line, const string& msg) {
+    return "line " + to_string(line) + ": " + msg;
+}
+
+// Rows parsed from one slice of the file by one worker thread
+struct ParsedChunk {
+    vector<ProcessOriginal> rows;
+    long long lines;        // Lines consumed (up to and including a bad one)
+    bool bad;               // Stopped at a malformed row (the last line consumed)
+    
+    ParsedChunk() : lines(0), bad(false) {}
+};
+
+void parse_chunk(const char* p, const char* end, size_t max_rows, ParsedChunk& chunk) {
+    vector<int> bursts;
+    while (p < end && chunk.rows.size() < max_rows) {
+        const char* nl = (const char*)memchr(p, '\n', end - p);
+        const char* line_end = nl ? nl : end;
+        chunk.lines++;
+        
+        int f[4];
+        LineResult r = scan_process(p, line_end, f, bursts);
+        if (r == LINE_BAD) {
+            chunk.bad = true;
+            return;
+        }
+        if (r == LINE_OK) {
+            chunk.rows.push_back(ProcessOriginal(f[0], f[1], f[2], f[3], BurstList(bursts)));
+        }
+        p = nl ? nl + 1 : end;
+    }
+}
+
+// ==================== BINARY TRACE FORMAT ====================
+// Columnar layout in host byte order, written by --convert:
+//   header (32 bytes): magic "MLFQTRC1", version, flags, count, arrival column size
+//   int32 pid[count]
+//   arrivals: int32[count], or with TRACE_DELTA_ARRIVALS (sorted traces)
+//             LEB128 varint gaps from the previous arrival (the first from 0)
+//   int32 burst[count]
+//   int32 initial_priority[count]
+// Loading copies whole columns, with no text parsing.
+
+const char TRACE_MAGIC[8] = {'M', 'L', 'F', 'Q', 'T', 'R', 'C', '1'};
+const uint32_t TRACE_VERSION = 1;
+const uint32_t TRACE_DELTA_ARRIVALS = 1;
+
+struct TraceHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t count;
+    uint64_t arrival_bytes;
+};
+
+bool is_binary_trace(const char* data, size_t size) {
+    return size >= sizeof(TRACE_MAGIC) && memcmp(data, TRACE_MAGIC, sizeof(TRACE_MAGIC)) == 0;
+}
+
+bool parse_binary_trace(const char* data, size_t size, vector<ProcessOriginal>& procs, string& error) {
+    TraceHeader h;
+    if (size < sizeof(h)) {
+        error = "truncated binary trace header";
+        return false;
+    }
+    memcpy(&h, data, sizeof(h));
+    if (h.version != TRACE_VERSION) {
+        error = "unsupported binary trace version " + to_string(h.version);
+        return false;
+    }
+    // Checked piece by piece so a corrupt header cannot make the sum wrap
+    if (h.count > INT_MAX) {
+        error = "binary trace size does not match its header";
+        return false;
+    }
+    uint64_t column = h.count * sizeof(int32_t);
+    uint64_t body = size - sizeof(h);
+    if (3 * column > body || h.arrival_bytes != body - 3 * column) {
+        error = "binary trace size does not match its header";
+        return false;
+    }
+    
+    size_t n = h.count;
+    const char* pids = data + sizeof(h);
+    const char* arrivals = pids + column;
+    const char* bursts = arrivals + h.arrival_bytes;
+    const char* prios = bursts + column;
+    
+    vector<int32_t> pid(n), arrival(n), burst(n), prio(n);
+    memcpy(pid.data(), pids, column);
+    memcpy(burst.data(), bursts, column);
+    memcpy(prio.data(), prios, column);
+    
+    if (h.flags & TRACE_DELTA_ARRIVALS) {
+        const unsigned char* p = (const unsigned char*)arrivals;
+        const unsigned char* end = p + h.arrival_bytes;
+        long long t = 0;
+        for (size_t i = 0; i < n; i++) {
+            uint64_t gap = 0;
+            int shift = 0;
+            do {
+                if (p == end || shift > 35) {
+                    error = "corrupt arrival column in binary trace";
+                    return false;
+                }
+                gap |= (uint64_t)(*p & 0x7f) << shift;
+                shift += 7;
+            } while (*p++ & 0x80);
+            t += gap;
+            if (t > INT_MAX) {
+                error = "arrival time out of range in binary trace";
+                return false;
+            }
+            arrival[i] = (int32_t)t;
+        }
+    } else if (h.arrival_bytes == column) {
+        memcpy(arrival.data(), arrivals, column);
+    } else {
+        error = "binary trace size does not match its header";
+        return false;
+    }
+    
+    procs.clear();
+    procs.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        procs.push_back(ProcessOriginal(pid[i], arrival[i], burst[i], prio[i]));
+    }
+    return true;
+}
+
+bool save_binary_trace(const string& filename, const vector<ProcessOriginal>& procs) {
+    size_t n = procs.size();
+    vector<int32_t> pid(n), burst(n), prio(n);
+    bool sorted = true;
+    for (size_t i = 0; i < n; i++) {
+        pid[i] = procs[i].pid;
+        burst[i] = procs[i].burst;
+        prio[i] = procs[i].initial_priority;
+        if (procs[i].arrival < (i == 0 ? 0 : procs[i - 1].arrival)) sorted = false;
+    }
+    
+    // Sorted, non-negative arrivals are stored as varint gaps
+    string arrivals;
+    if (sorted) {
+        int prev = 0;
+        for (auto& p : procs) {
+            uint32_t gap = p.arrival - prev;
+            prev = p.arrival;
+            while (gap >= 0x80) {
+                arrivals.push_back((char)(gap | 0x80));
+                gap >>= 7;
+            }
+            arrivals.push_back((char)gap);
+        }
+    } else {
+        arrivals.resize(n * sizeof(int32_t));
+        for (size_t i = 0; i < n; i++) {
+            int32_t a = procs[i].arrival;
+            memcpy(&arrivals[i * sizeof(int32_t)], &a, sizeof(a));
+        }
+    }
+    
+    TraceHeader h;
+    memcpy(h.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    h.version = TRACE_VERSION;
+    h.flags = sorted ? TRACE_DELTA_ARRIVALS : 0;
+    h.count = n;
+    h.arrival_bytes = arrivals.size();
+    
+    ofstream fout(filename, ios::binary);
+    if (!fout) return false;
+    fout.write((const char*)&h, sizeof(h));
+    fout.write((const char*)pid.data(), n * sizeof(int32_t));
+    fout.write(arrivals.data(), arrivals.size());
+    fout.write((const char*)burst.data(), n * sizeof(int32_t));
+    fout.write((const char*)prio.data(), n * sizeof(int32_t));
+    return (bool)fout;
+}
+
+// Read the rest of a file into data. Files are read in one go at their
+// size; pipes and other unseekable inputs, which have none, in chunks
+// until end of file. False if the input cannot be read (a directory).
+bool read_whole_file(ifstream& fin, vector<char>& data) {
+    if (fin.peek() == EOF && fin.bad()) return false;
+    fin.clear();
+    streampos start = fin.tellg();
+    fin.seekg(0, ios::end);
+    streampos end = fin.tellg();
+    if (start != streampos(-1) && end != streampos(-1)) {
+        fin.seekg(start);
+        data.resize(end - start);
+        return (bool)fin.read(data.data(), data.size());
+    }
+    fin.clear();
+    data.assign(istreambuf_iterator<char>(fin), istreambuf_iterator<char>());
+    return !fin.bad();
+}
+
+// Load a whole process file, text or binary. Text files of several MB are
+// parsed by one thread per core, each on a slice that starts at a line
+// boundary.
+bool load_process_file(const string& filename, vector<ProcessOriginal>& procs, string& error) {
+    ifstream fin(filename, ios::binary);
+    if (!fin) {
+        error = "cannot open file";
+        return false;
+    }
+    vector<char> data;
+    if (!read_whole_file(fin, data)) {
+        error = "cannot read file";
+        return false;
+    }
+    fin.close();
+    size_t size = data.size();
+    
+    if (is_binary_trace(data.data(), size)) {
+        return parse_binary_trace(data.data(), size, procs, error);
+    }
+    
+    const char* p = data.data();
+    const char* end = p + size;
+    
+    // Header: first non-blank line holds the process count
+    long long line = 0;
+    int n = 0;
+    LineResult r = LINE_BLANK;
+    while (p < end && r == LINE_BLANK) {
+        const char* nl = (const char*)memchr(p, '\n', end - p);
+        const char* line_end = nl ? nl : end;
+        line++;
+        r = scan_ints(p, line_end, &n, 1);
+        p = nl ? nl + 1 : end;
+    }
+    if (r != LINE_OK || n < 0) {
+        error = (r == LINE_BLANK) ? "empty file" : line_error(line, "expected the number of processes");
+        return false;
+    }
+    
+    // Split the rest into slices at line boundaries
+    size_t workers = 1;
+    if ((size_t)(end - p) >= ((size_t)8 << 20)) {
+        workers = max(1u, min(thread::hardware_concurrency(), 16u));
+    }
+    vector<const char*> bounds(workers + 1, end);
+    bounds[0] = p;
+    for (size_t i = 1; i < workers; i++) {
+        const char* cut = max(bounds[i - 1], p + (end - p) * i / workers);
+        const char* nl = (const char*)memchr(cut, '\n', end - cut);
+        bounds[i] = nl ? nl + 1 : end;
+    }
+    
+    vector<ParsedChunk> chunks(workers);
+    vector<thread> threads;
+    for (size_t i = 1; i < workers; i++) {
+        threads.emplace_back(parse_chunk, bounds[i], bounds[i + 1], (size_t)n, ref(chunks[i]));
+    }
+    parse_chunk(bounds[0], bounds[1], (size_t)n, chunks[0]);
+    for (auto& t : threads) t.join();
+    
+    // Stitch the slices back together in file order
+    procs.clear();
+    procs.reserve(n);
+    for (auto& chunk : chunks) {
+        size_t take = min(chunk.rows.size(), (size_t)n - procs.size());
+        procs.insert(procs.end(), chunk.rows.begin(), chunk.rows.begin() + take);
+        if (procs.size() == (size_t)n) return true;
+        
+        line += chunk.lines;
+        if (chunk.bad) {
+            error = line_error(line, ROW_FORMAT);
+            return false;
+        }
+    }
+    error = "expected " + to_string(n) + " processes, found " + to_string(procs.size());
+    return false;
+}
+
+// ==================== STREAMING TRACE READER ====================
+// Processes handed out one at a time in arrival order (streaming mode)
+class ProcessSource {
+public:
+    virtual ~ProcessSource() {}
+    
+    virtual bool empty() = 0;
+    
+    // Next process in arrival order; only valid if !empty()
+    virtual const ProcessOriginal& peek() = 0;
+    virtual ProcessOriginal next() = 0;
+    
+    // Whether some not-yet-handed-out process arrives after time t
+    virtual bool has_arrival_after(int t) = 0;
+};
+
+// Reads a process file lazily, one process at a time in arrival order, so
+// only processes that were looked at but not yet handed out are held in
+// memory. The file is read in large blocks and must be sorted by arrival.
+class TraceReader : public ProcessSource {
+private:
+    ifstream fin;
+    vector<char> buf;
+    size_t buf_pos;
+    size_t buf_len;
+    bool at_eof;
+    long long line;
+    long long rows_left;
+    long long rows_read;
+    deque<ProcessOriginal> lookahead;
+    vector<int> bursts;         // Scratch for scan_process()
+    int last_handed_out;
+    string error_msg;
+    
+    // Next line of the file as [b, e), refilling the block buffer as needed
+    bool next_line(const char*& b, const char*& e) {
+        while (true) {
+            const char* start = buf.data() + buf_pos;
+            const char* nl = (const char*)memchr(start, '\n', buf_len - buf_pos);
+            if (nl != nullptr || (at_eof && buf_pos < buf_len)) {
+                b = start;
+                e = nl ? nl : buf.data() + buf_len;
+                buf_pos = (e - buf.data()) + (nl ? 1 : 0);
+                line++;
+                return true;
+            }
+            if (at_eof) return false;
+            
+            // Keep the partial line, grow the buffer if it is a single line
+            memmove(buf.data(), start, buf_len - buf_pos);
+            buf_len -= buf_pos;
+            buf_pos = 0;
+            if (buf_len == buf.size()) buf.resize(buf.size() * 2);
+            fin.read(buf.data() + buf_len, buf.size() - buf_len);
+            buf_len += fin.gcount();
+            at_eof = !fin;
+        }
+    }
+    
+    // Read one more process into the lookahead buffer
+    bool read_one() {
+        if (rows_left == 0 || !error_msg.empty()) return false;
+        
+        const char* b;
+        const char* e;
+        int f[4];
+        LineResult r = LINE_BLANK;
+        while (r == LINE_BLANK && next_line(b, e)) {
+            r = scan_process(b, e, f, bursts);
+        }
+        if (r == LINE_BLANK) {
+            error_msg = "expected " + to_string(rows_read + rows_left) + 
+                        " processes, found " + to_string(rows_read);
+            return false;
+        }
+        if (r == LINE_BAD) {
+            error_msg = line_error(line, ROW_FORMAT);
+            return false;
+        }
+        rows_read++;
+        rows_left--;
+        
+        int last_arrival = lookahead.empty() ? last_handed_out : lookahead.back().arrival;
+        if (f[1] < last_arrival) {
+            error_msg = line_error(line, "P" + to_string(f[0]) + 
+                " arrives before the previous process; streaming needs a file sorted by arrival");
+            return false;
+        }
+        lookahead.push_back(ProcessOriginal(f[0], f[1], f[2], f[3], BurstList(bursts)));
+        return true;
+    }
+    
+public:
+    TraceReader() : buf(1 << 20), buf_pos(0), buf_len(0), at_eof(false), line(0),
+                    rows_left(0), rows_read(0), last_handed_out(INT_MIN) {}
+    
+    bool open(const string& filename) {
+        fin.open(filename, ios::binary);
+        if (!fin) return false;
+        
+        fin.read(buf.data(), buf.size());
+        buf_len = fin.gcount();
+        at_eof = !fin;
+        if (is_binary_trace(buf.data(), buf_len)) {
+            error_msg = "binary traces cannot be streamed; load them without -s";
+            return true;
+        }
+        
+        const char* b;
+        const char* e;
+        int n = 0;
+        LineResult r = LINE_BLANK;
+        while (r == LINE_BLANK && next_line(b, e)) {
+            r = scan_ints(b, e, &n, 1);
+        }
+        if (r != LINE_OK || n < 0) {
+            error_msg = line_error(line, "expected the number of processes");
+        } else {
+            rows_left = n;
+        }
+        return true;
+    }
+    bool empty() override {
+        return lookahead.empty() && !read_one();
+    }
+    
+    const ProcessOriginal& peek() override {
+        return lookahead.front();
+    }
     
-    ProcessOriginal(int p, int a, int b, int prio = 0) 
-        : pid(p), arrival(a), burst(b), initial_priority(prio) {}
+    ProcessOriginal next() override {
+        ProcessOriginal p = move(lookahead.front());
+        lookahead.pop_front();
+        last_handed_out = p.arrival;
+        return p;
+    }
+    
+    // Reads ahead at most past the processes arriving at or before t
+    bool has_arrival_after(int t) override {
+        if (!lookahead.empty() && lookahead.back().arrival > t) return true;
+        while (read_one()) {
+            if (lookahead.back().arrival > t) return true;
+        }
+        return false;
+    }
+    
+    long long processes_read() const { return rows_read; }
+    const string& error() const { return error_msg; }
+};
+
+// A workload already in memory, handed out in arrival order
+class ProcessList : public ProcessSource {
+private:
+    vector<ProcessOriginal> procs;
+    size_t next_index;
+    
+public:
+    // Sorted by arrival, ties by PID, as main() orders MLFQ's input
+    explicit ProcessList(const vector<ProcessOriginal>& list) : procs(list), next_index(0) {
+        stable_sort(procs.begin(), procs.end(), 
+                    [](const ProcessOriginal& a, const ProcessOriginal& b) {
+                        return a.arrival < b.arrival || (a.arrival == b.arrival && a.pid < b.pid);
+                    });
+    }
+    
+    bool empty() override { return next_index == procs.size(); }
+    const ProcessOriginal& peek() override { return procs[next_index]; }
+    ProcessOriginal next() override { return procs[next_index++]; }
+    
+    bool has_arrival_after(int t) override {
+        return !empty() && procs.back().arrival > t;
+    }
 };
 
 // ==================== CONFIGURATION ====================
@@ -74,6 +701,7 @@ struct Config {
     int aging_threshold;
     int aging_check_interval;
     int boost_interval;
+    bool allotment;         // A level's quantum is a CPU allotment kept across I/O
     
     Config() {
         num_queues = 3;
@@ -82,31 +710,45 @@ struct Config {
         aging_threshold = 15;
         aging_check_interval = 3;
         boost_interval = 50;
+        allotment = false;
     }
     
+    // Leaves the configuration untouched if the file is missing or invalid
     bool load_from_file(const string& filename) {
         ifstream fin(filename);
         if (!fin) return false;
         
-        fin >> num_queues;
-        time_quantum.resize(num_queues);
-        algo_names.resize(num_queues);
+        Config loaded;
+        fin >> loaded.num_queues;
+        if (!fin || loaded.num_queues < 1) return false;
+        loaded.time_quantum.resize(loaded.num_queues);
+        loaded.algo_names.resize(loaded.num_queues);
         
-        for (int i = 0; i < num_queues; i++) {
-            fin >> time_quantum[i];
+        for (int i = 0; i < loaded.num_queues; i++) {
+            fin >> loaded.time_quantum[i];
         }
         
         fin.ignore();
-        for (int i = 0; i < num_queues; i++) {
-            getline(fin, algo_names[i]);
+        for (int i = 0; i < loaded.num_queues; i++) {
+            getline(fin, loaded.algo_names[i]);
         }
         
-        fin >> aging_threshold >> aging_check_interval >> boost_interval;
+        fin >> loaded.aging_threshold >> loaded.aging_check_interval >> loaded.boost_interval;
+        if (!fin || loaded.aging_check_interval < 1 || loaded.boost_interval < 1) return false;
+        
+        // Optional quantum accounting line
+        string accounting;
+        if (fin >> accounting) {
+            if (accounting == "Allotment") loaded.allotment = true;
+            else if (accounting != "Quantum") return false;
+        }
         fin.close();
+        
+        *this = loaded;
         return true;
     }
     
-    void display() {
+    void display() const {
         cout << "Configuration:\n";
         cout << "  Number of Queues: " << num_queues << "\n";
         for (int i = 0; i < num_queues; i++) {
@@ -119,6 +761,9 @@ struct Config {
         cout << "  Aging Threshold: " << aging_threshold << " time units\n";
         cout << "  Aging Check Interval: Every " << aging_check_interval << " time units\n";
         cout << "  Priority Boost Interval: Every " << boost_interval << " time units\n";
+        if (allotment) {
+            cout << "  Quantum Accounting: Allotment (CPU use at a level adds up across I/O)\n";
+        }
     }
 };
 
@@ -129,6 +774,9 @@ struct Metrics {
     double throughput;
     double cpu_util;
     int context_switches;
+    vector<double> cpu_utilization;     // SMP runs only: % busy of each CPU
+    vector<long long> cpu_migrations;   // and the processes each one stole
+    vector<long long> level_cpu;        // MLFQ only: CPU time run at each level
     
     void display(const string& scheduler_name) {
         cout << "\n" << scheduler_name << " Performance:\n";
@@ -137,881 +785,3353 @@ struct Metrics {
         cout << "  Throughput         : " << fixed << setprecision(3) << throughput << " jobs/unit\n";
         cout << "  CPU Utilization    : " << fixed << setprecision(2) << cpu_util << " %\n";
         cout << "  Context Switches   : " << context_switches << "\n";
+        if (!cpu_utilization.empty()) {
+            long long migrations = 0;
+            for (long long n : cpu_migrations) migrations += n;
+            cout << "  CPUs               : " << cpu_utilization.size() << "\n";
+            cout << "  Migrations         : " << migrations << "\n";
+        }
+    }
+    
+    void display_levels(const Config& config) const {
+        long long busy = 0;
+        for (long long t : level_cpu) busy += t;
+        cout << "Queue Usage Statistics:\n";
+        for (int q = 0; q < config.num_queues; q++) {
+            cout << "  Q" << q << " (" << config.algo_names[q] << "): " 
+                 << level_cpu[q] << " time units ("
+                 << fixed << setprecision(1) << (100.0 * level_cpu[q] / busy)
+                 << "%)\n";
+        }
+        cout << "\n";
     }
 };
 
-// ==================== MLFQ SCHEDULER CLASS ====================
-class MLFQ_Scheduler {
-private:
-    vector<Process> all_processes;
-    deque<Process*> queues[10];
-    Config config;
-    int current_time;
+// Totals over completed processes, shared by all schedulers
+struct MetricsAccumulator {
     int completed;
-    int total_busy_time;
-    int context_switches;
-    vector<int> timeline_pid;
-    vector<int> timeline_queue;
-    Process* currently_running;
-    bool verbose_mode;
+    long long total_turnaround;
+    long long total_waiting;
+    int last_completion;
     
-public:
-    MLFQ_Scheduler(vector<Process>& procs, const Config& cfg) {
-        all_processes = procs;
-        config = cfg;
-        current_time = 0;
-        completed = 0;
-        total_busy_time = 0;
-        context_switches = 0;
-        currently_running = nullptr;
-        verbose_mode = true;
+    MetricsAccumulator() : completed(0), total_turnaround(0), total_waiting(0), last_completion(0) {}
+    
+    void add(const Process& p) {
+        int tat = p.completion - p.arrival;
+        completed++;
+        total_turnaround += tat;
+        total_waiting += tat - p.burst - p.io_time;
+        last_completion = max(last_completion, p.completion);
     }
     
-    void add_arrivals() {
-        for (auto& p : all_processes) {
-            if (p.arrival == current_time && !p.started && p.start_time == -1) {
-                // Validate and clamp initial priority to valid range
-                p.priority = min(p.initial_priority, config.num_queues - 1);
-                p.priority = max(0, p.priority);
-                
-                // Place in queue based on initial priority
-                queues[p.priority].push_back(&p);
-                
-                if (verbose_mode) {
-                    cout << "Time " << current_time << ": Process P" << p.pid 
-                         << " arrived -> Q" << p.priority;
-                    if (p.initial_priority > 0) {
-                        cout << " (initial priority: " << p.initial_priority << ")";
-                    }
-                    cout << "\n";
-                }
-            }
-        }
+    void merge(const MetricsAccumulator& other) {
+        completed += other.completed;
+        total_turnaround += other.total_turnaround;
+        total_waiting += other.total_waiting;
+        last_completion = max(last_completion, other.last_completion);
     }
     
-    void apply_aging() {
-        for (int q = 1; q < config.num_queues; q++) {
-            for (auto it = queues[q].begin(); it != queues[q].end(); ) {
-                Process* p = *it;
-                
-                if (p != currently_running && p->time_in_queue >= config.aging_threshold) {
-                    if (verbose_mode) {
-                        cout << "Time " << current_time << ": Process P" << p->pid 
-                             << " promoted Q" << q << " -> Q" << (q-1) << " (Aging)";
-                        
-                        // Show current state
-                        if (currently_running != nullptr) {
-                            cout << " [P" << currently_running->pid 
-                                 << " currently running in Q" << currently_running->priority << "]\n";
-                        } else {
-                            cout << " [Will get CPU time in Q" << (q-1) << "]\n";
-                        }
-                    }
-                    
-                    // Promote to higher priority queue
-                    p->priority = q - 1;
-                    p->time_in_queue = 0;
-                    p->time_in_current_quantum = 0;
-                    queues[q - 1].push_back(p);
-                    it = queues[q].erase(it);
-                } else {
-                    ++it;
-                }
-            }
+    Metrics finish(long long total_busy_time, int context_switches) const {
+        Metrics m;
+        m.avg_turnaround = (double)total_turnaround / completed;
+        m.avg_waiting = (double)total_waiting / completed;
+        m.throughput = (double)completed / max(1, last_completion);
+        m.cpu_util = 100.0 * total_busy_time / max(1, last_completion);
+        m.context_switches = context_switches;
+        return m;
+    }
+};
+
+// ==================== LATENCY DISTRIBUTION ====================
+// Log-linear histogram of non-negative integer latencies (HDR-style).
+// Values below 64 are counted exactly; above that every power of two is
+// split into 32 buckets, so a reported percentile is at most 1/32 above
+// the true value. Memory is fixed however many values are recorded.
+class LatencyHistogram {
+private:
+    static const int SUB_BUCKETS = 32;
+    static const int NUM_BUCKETS = 864;     // Enough for INT_MAX
+    
+    vector<uint64_t> counts;    // Allocated on first record
+    uint64_t total;
+    int max_value;
+    
+    static int bucket_of(int v) {
+        if (v < 2 * SUB_BUCKETS) return v;
+        int e = 31 - __builtin_clz(v) - 5;  // v >> e in [32, 64)
+        return e * SUB_BUCKETS + (v >> e);
+    }
+    
+    // Largest value counted in bucket i
+    static int highest_in(int i) {
+        if (i < 2 * SUB_BUCKETS) return i;
+        int e = i / SUB_BUCKETS - 1;
+        long long m = i % SUB_BUCKETS + SUB_BUCKETS;
+        return (int)min<long long>(INT_MAX, ((m + 1) << e) - 1);
+    }
+
+public:
+    LatencyHistogram() : total(0), max_value(0) {}
+    
+    void record(int v) {
+        if (counts.empty()) counts.assign(NUM_BUCKETS, 0);
+        v = max(0, v);
+        counts[bucket_of(v)]++;
+        total++;
+        max_value = max(max_value, v);
+    }
+    
+    void merge(const LatencyHistogram& other) {
+        if (other.total == 0) return;
+        if (counts.empty()) counts.assign(NUM_BUCKETS, 0);
+        for (int i = 0; i < NUM_BUCKETS; i++) {
+            counts[i] += other.counts[i];
         }
+        total += other.total;
+        max_value = max(max_value, other.max_value);
     }
     
-    void apply_priority_boost() {
-        if (verbose_mode) {
-            cout << "\n" << string(60, '=') << "\n";
-            cout << "Time " << current_time 
-                 << ": PRIORITY BOOST - All processes reset to initial priority\n";
-            cout << string(60, '=') << "\n";
+    uint64_t count() const { return total; }
+    int maximum() const { return max_value; }
+    
+    // Smallest bucket bound with at least p% of the values at or below it
+    int percentile(double p) const {
+        if (total == 0) return 0;
+        uint64_t rank = max<uint64_t>(1, (uint64_t)ceil(p / 100.0 * total));
+        uint64_t seen = 0;
+        for (int i = 0; i < NUM_BUCKETS; i++) {
+            seen += counts[i];
+            if (seen >= rank) return min(highest_in(i), max_value);
         }
+        return max_value;
+    }
+};
+
+// Turnaround, waiting and response time (first run minus arrival)
+// distributions, overall and per initial priority level
+class LatencyReport {
+private:
+    struct Group {
+        LatencyHistogram turnaround;
+        LatencyHistogram waiting;
+        LatencyHistogram response;
         
-        vector<Process*> all_waiting;
-        map<int, vector<int>> queue_movements;  // Track movements
-        
-        // Collect processes from all queues except Q0
-        for (int q = 1; q < config.num_queues; q++) {
-            for (auto p : queues[q]) {
-                // Track where process is moving (for display)
-                if (p->initial_priority != q) {
-                    queue_movements[q].push_back(p->pid);
-                }
-                
-                // Reset to initial priority (respects original importance)
-                p->priority = p->initial_priority;
-                p->time_in_queue = 0;
-                p->time_in_current_quantum = 0;
-                all_waiting.push_back(p);
-            }
-            queues[q].clear();
+        void add(const Process& p) {
+            turnaround.record(p.completion - p.arrival);
+            waiting.record(p.completion - p.arrival - p.burst - p.io_time);
+            response.record(p.start_time - p.arrival);
         }
         
-        // Show detailed movements
-        if (verbose_mode) {
-            for (map<int, vector<int>>::iterator it = queue_movements.begin(); 
-                 it != queue_movements.end(); ++it) {
-                int from_queue = it->first;
-                vector<int>& pids = it->second;
-                
-                if (!pids.empty()) {
-                    cout << "  Q" << from_queue << " -> Reset: ";
-                    for (size_t i = 0; i < pids.size(); i++) {
-                        cout << "P" << pids[i];
-                        if (i < pids.size() - 1) cout << ", ";
-                    }
-                    cout << "\n";
-                }
-            }
-        }
-        
-        // Place processes in their initial priority queues
-        for (size_t i = 0; i < all_waiting.size(); i++) {
-            queues[all_waiting[i]->priority].push_back(all_waiting[i]);
-        }
-        
-        // Reset currently running process if below initial priority
-        if (currently_running != nullptr && 
-            currently_running->priority > currently_running->initial_priority) {
-            if (verbose_mode) {
-                cout << "  Running: P" << currently_running->pid 
-                     << " reset from Q" << currently_running->priority 
-                     << " to Q" << currently_running->initial_priority << "\n";
-            }
-            currently_running->priority = currently_running->initial_priority;
-            currently_running->time_in_current_quantum = 0;
-        }
-        
-        if (verbose_mode) {
-            cout << string(60, '=') << "\n\n";
+        void merge(const Group& other) {
+            turnaround.merge(other.turnaround);
+            waiting.merge(other.waiting);
+            response.merge(other.response);
         }
+    };
+    
+    Group all;
+    vector<Group> by_level;
+    
+    static void print_row(ostream& out, const string& group, const string& metric,
+                          const LatencyHistogram& h) {
+        out << left << setw(22) << group << setw(12) << metric << right
+            << setw(9) << h.percentile(50) << setw(9) << h.percentile(90)
+            << setw(9) << h.percentile(99) << setw(9) << h.percentile(99.9)
+            << setw(9) << h.maximum() << "\n";
     }
     
-    void update_waiting_times() {
-        for (int q = 0; q < config.num_queues; q++) {
-            for (auto p : queues[q]) {
-                if (p != currently_running && p->remaining > 0) {
-                    p->time_in_queue++;
-                }
-            }
-        }
+    static void print_group(ostream& out, const string& label, const Group& g) {
+        string group = label + " (" + to_string(g.turnaround.count()) + ")";
+        print_row(out, group, "Turnaround", g.turnaround);
+        print_row(out, "", "Waiting", g.waiting);
+        print_row(out, "", "Response", g.response);
+    }
+
+public:
+    void reset(int num_levels) {
+        all = Group();
+        by_level.assign(num_levels, Group());
     }
     
-    int get_highest_priority_queue() {
-        for (int q = 0; q < config.num_queues; q++) {
-            if (!queues[q].empty()) {
-                return q;
-            }
-        }
-        return -1;
+    void add(const Process& p, int level) {
+        all.add(p);
+        by_level[level].add(p);
     }
     
-    bool should_preempt(int running_queue) {
-        for (int q = 0; q < running_queue; q++) {
-            if (!queues[q].empty()) {
-                return true;
-            }
+    // Add the processes recorded in `other`, which has the same levels
+    void merge(const LatencyReport& other) {
+        all.merge(other.all);
+        for (size_t q = 0; q < by_level.size(); q++) {
+            by_level[q].merge(other.by_level[q]);
         }
-        return false;
     }
     
-    void run(bool verbose = true) {
-        verbose_mode = verbose;
-        
-        if (verbose_mode) {
-            cout << "\n========================================\n";
-            cout << "MLFQ SCHEDULER \n";
-            cout << "========================================\n";
-            config.display();
-            cout << "========================================\n\n";
-        }
-        
-        while (completed < all_processes.size()) {
-            add_arrivals();
-            
-            // Remove completed processes
-            for (int q = 0; q < config.num_queues; q++) {
-                queues[q].erase(
-                    remove_if(queues[q].begin(), queues[q].end(),
-                             [](Process* p){ return p->remaining <= 0; }),
-                    queues[q].end()
-                );
-            }
-            
-            if (current_time > 0 && current_time % config.aging_check_interval == 0) {
-                apply_aging();
-            }
-            
-            if (current_time > 0 && current_time % config.boost_interval == 0) {
-                apply_priority_boost();
-            }
-            
-            // Check for preemption
-            if (currently_running != nullptr && currently_running->remaining > 0) {
-                int running_queue = currently_running->priority;
-                
-                if (should_preempt(running_queue)) {
-                    if (verbose_mode) {
-                        cout << "Time " << current_time << ": Process P" << currently_running->pid 
-                             << " preempted in Q" << running_queue;
-                        
-                        // Show what will run next
-                        int next_queue = get_highest_priority_queue();
-                        if (next_queue != -1 && !queues[next_queue].empty()) {
-                            cout << " -> P" << queues[next_queue].front()->pid 
-                                 << " will run in Q" << next_queue << "\n";
-                        } else {
-                            cout << "\n";
-                        }
-                    }
-                    queues[running_queue].push_front(currently_running);
-                    currently_running = nullptr;
-                    context_switches++;
-                }
-            }
-            
-            // Get next process if none running
-            if (currently_running == nullptr || currently_running->remaining == 0) {
-                int active_queue = get_highest_priority_queue();
-                
-                if (active_queue == -1) {
-                    // CPU idle
-                    bool has_future = false;
-                    int next_time = current_time + 1;
-                    
-                    for (auto& p : all_processes) {
-                        if (p.arrival > current_time && p.remaining > 0) {
-                            has_future = true;
-                            next_time = min(next_time, p.arrival);
-                        }
-                    }
-                    
-                    if (has_future) {
-                        if (verbose_mode) {
-                            cout << "Time " << current_time << ": CPU Idle (waiting for arrivals)\n";
-                        }
-                        timeline_pid.push_back(0);
-                        timeline_queue.push_back(-1);
-                        current_time++;
-                    } else {
-                        break;
-                    }
-                    continue;
-                }
-                
-                currently_running = queues[active_queue].front();
-                queues[active_queue].pop_front();
-                
-                if (!currently_running->started) {
-                    currently_running->started = true;
-                    currently_running->start_time = current_time;
-                    context_switches++;
-                    
-                    if (verbose_mode) {
-                        cout << "Time " << current_time << ": Process P" << currently_running->pid 
-                             << " starts execution in Q" << active_queue 
-                             << " (first time)\n";
-                    }
-                } else {
-                    context_switches++;
-                    
-                    if (verbose_mode) {
-                        cout << "Time " << current_time << ": Process P" << currently_running->pid 
-                             << " resumes execution in Q" << active_queue << "\n";
-                    }
-                }
-            }
-            
-            // Execute for 1 time unit
-            timeline_pid.push_back(currently_running->pid);
-            timeline_queue.push_back(currently_running->priority);
-            
-            currently_running->remaining--;
-            currently_running->time_in_current_quantum++;
-            total_busy_time++;
-            
-            update_waiting_times();
-            
-            // Check for completion
-            if (currently_running->remaining == 0) {
-                currently_running->completion = current_time + 1;
-                completed++;
-                
-                if (verbose_mode) {
-                    cout << "Time " << (current_time + 1) << ": Process P" << currently_running->pid 
-                         << " completed in Q" << currently_running->priority;
-                    
-                    // Show what will run next
-                    int next_queue = get_highest_priority_queue();
-                    if (next_queue != -1 && !queues[next_queue].empty()) {
-                        cout << " -> P" << queues[next_queue].front()->pid 
-                             << " will run next in Q" << next_queue << "\n";
-                    } else if (completed < all_processes.size()) {
-                        // Check if there are future arrivals
-                        bool has_future = false;
-                        for (auto& p : all_processes) {
-                            if (p.arrival > current_time + 1 && p.remaining > 0) {
-                                has_future = true;
-                                break;
-                            }
-                        }
-                        if (has_future) {
-                            cout << " -> CPU will be idle\n";
-                        } else {
-                            cout << "\n";
-                        }
-                    } else {
-                        cout << " -> All processes completed\n";
-                    }
-                }
-                currently_running = nullptr;
-            }
-            // Check if quantum exhausted (demotion)
-            else if (config.time_quantum[currently_running->priority] > 0 && 
-                     currently_running->time_in_current_quantum >= config.time_quantum[currently_running->priority]) {
-                
-                int old_queue = currently_running->priority;
-                
-                // Demote to lower priority queue (MLFQ feedback)
-                if (currently_running->priority < config.num_queues - 1) {
-                    currently_running->priority++;
-                    
-                    if (verbose_mode) {
-                        cout << "Time " << (current_time + 1) << ": Process P" << currently_running->pid 
-                             << " demoted Q" << old_queue << " -> Q" << currently_running->priority 
-                             << " (Quantum exhausted)";
-                        
-                        // Show what will run next
-                        int next_queue = get_highest_priority_queue();
-                        if (next_queue != -1 && !queues[next_queue].empty()) {
-                            cout << " -> P" << queues[next_queue].front()->pid 
-                                 << " will run in Q" << next_queue << "\n";
-                        } else {
-                            cout << " -> P" << currently_running->pid 
-                                 << " continues in Q" << currently_running->priority << "\n";
-                        }
-                    }
-                } else {
-                    // Already at lowest queue
-                    if (verbose_mode) {
-                        cout << "Time " << (current_time + 1) << ": Process P" << currently_running->pid 
-                             << " quantum exhausted in Q" << old_queue << " (stays in Q" << old_queue << ")";
-                        
-                        // Show what will run next
-                        if (!queues[old_queue].empty()) {
-                            cout << " -> P" << queues[old_queue].front()->pid 
-                                 << " will run in Q" << old_queue << "\n";
-                        } else {
-                            cout << " -> P" << currently_running->pid 
-                                 << " continues in Q" << old_queue << "\n";
-                        }
-                    }
-                }
-                
-                currently_running->time_in_current_quantum = 0;
-                currently_running->time_in_queue = 0;
-                queues[currently_running->priority].push_back(currently_running);
-                currently_running = nullptr;
-                context_switches++;
+    // Table of percentiles, ending with a blank line
+    void print(ostream& out) const {
+        out << "Latency Percentiles:\n";
+        out << left << setw(22) << "Group" << setw(12) << "Metric" << right
+            << setw(9) << "p50" << setw(9) << "p90" << setw(9) << "p99"
+            << setw(9) << "p99.9" << setw(9) << "max" << "\n";
+        print_group(out, "All", all);
+        for (size_t q = 0; q < by_level.size(); q++) {
+            if (by_level[q].turnaround.count() > 0) {
+                print_group(out, "Priority " + to_string(q), by_level[q]);
             }
-            
-            current_time++;
         }
-        
-        if (verbose_mode) {
-            print_results();
+        out << "\n";
+    }
+};
+
+// ==================== TIMELINE ====================
+// One Gantt chart bar: a process (pid 0 = idle) running in one queue
+// (-1 when idle) for `length` time units from `start`
+struct TimelineSegment {
+    int pid;
+    int queue;
+    int start;
+    int length;
+};
+
+// ==================== EVENT LOG ====================
+// MLFQ reports what it does as fixed-size event records to a sink chosen
+// at compile time. Silent runs use NullSink, so the simulation loop carries
+// no logging code at all; verbose runs use VerboseSink (see below).
+enum EventType {
+    EVENT_ARRIVAL,      // pid entered `queue` (-1: no CPU burst, completed on arrival); arg = initial priority
+    EVENT_DISPATCH,     // pid got the CPU in `queue`; EVENT_FIRST if it never ran before
+    EVENT_PREEMPTION,   // pid went back to the front of `queue` for a higher queue
+    EVENT_DEMOTION,     // pid's quantum expired in `queue`, moves to `to_queue` (may be the same)
+    EVENT_AGING,        // pid promoted from `queue` to `to_queue`
+    EVENT_BOOST,        // Priority boost
+    EVENT_BOOST_RESET,  // pid reset from `queue` to `to_queue` by the boost; EVENT_RUNNING if on the CPU
+    EVENT_COMPLETION,   // pid finished in `queue`
+    EVENT_IDLE,         // CPU idle until arg; EVENT_BLOCKED if some process is doing I/O
+    EVENT_BLOCK,        // pid's CPU burst ended in `queue`: blocked for arg units of I/O, returns to `to_queue`
+    EVENT_WAKE          // pid's I/O finished, entered `queue`
+};
+
+enum EventFlags {
+    EVENT_FIRST = 1,        // Dispatch: first time on the CPU
+    EVENT_RUNNING = 2,      // Aging / boost reset: other_pid (aging) or pid (reset) is running
+    EVENT_IDLE_NEXT = 4,    // Completion: nothing ready, CPU idles until an arrival
+    EVENT_ALL_DONE = 8,     // Completion: no process left
+    EVENT_BLOCKED = 16      // Boost reset: pid is blocked; idle: waiting for I/O too
+};
+
+// One scheduling event. other_pid/other_queue name the process that runs
+// next (or, for aging, the one running), 0/-1 if none.
+struct SchedEvent {
+    int32_t time;
+    int32_t pid;
+    int32_t queue;
+    int32_t to_queue;
+    int32_t other_pid;
+    int32_t other_queue;
+    int32_t arg;
+    uint8_t type;
+    uint8_t flags;
+    uint16_t reserved;
+};
+
+SchedEvent make_event(int type, int time, int pid, int queue) {
+    SchedEvent e;
+    e.time = time;
+    e.pid = pid;
+    e.queue = queue;
+    e.to_queue = queue;
+    e.other_pid = 0;
+    e.other_queue = -1;
+    e.arg = 0;
+    e.type = type;
+    e.flags = 0;
+    e.reserved = 0;
+    return e;
+}
+
+// Turns events back into the verbose log lines. Keeps state across calls:
+// the resets of one boost are grouped per source queue and the boost banner
+// is closed by the first event after them.
+class EventFormatter {
+private:
+    int reset_queue;    // Source queue of the open "Qn -> Reset:" line, -1 if none
+    bool in_boost;
+    
+    void end_reset_line(string& out) {
+        if (reset_queue != -1) {
+            out += "\n";
+            reset_queue = -1;
         }
     }
     
-    Metrics get_metrics() {
-        Metrics m;
-        double total_turnaround = 0.0, total_waiting = 0.0;
-        int last_completion = 0;
-        
-        for (auto& p : all_processes) {
-            int tat = p.completion - p.arrival;
-            int wt = tat - p.burst;
-            total_turnaround += tat;
-            total_waiting += wt;
-            last_completion = max(last_completion, p.completion);
+    static void add(string& out, const char* text, long long value) {
+        out += text;
+        out += to_string(value);
+    }
+    
+    // " -> P<n> will run[ next] in Q<q>" or the given fallback
+    static void add_next(string& out, const SchedEvent& e, const char* will_run, const string& otherwise) {
+        if (e.other_pid != 0) {
+            add(out, " -> P", e.other_pid);
+            out += will_run;
+            add(out, " in Q", e.other_queue);
+            out += "\n";
+        } else {
+            out += otherwise;
         }
-        
-        m.avg_turnaround = total_turnaround / all_processes.size();
-        m.avg_waiting = total_waiting / all_processes.size();
-        m.throughput = (double)all_processes.size() / max(1, last_completion);
-        m.cpu_util = 100.0 * total_busy_time / max(1, last_completion);
-        m.context_switches = context_switches;
-        
-        return m;
     }
+
+public:
+    EventFormatter() : reset_queue(-1), in_boost(false) {}
     
-    void print_results() {
-        cout << "\n========================================\n";
-        cout << "MLFQ SCHEDULER RESULTS\n";
-        cout << "========================================\n\n";
-        
-        map<int, int> queue_usage;
-        for (int q : timeline_queue) {
-            if (q >= 0) queue_usage[q]++;
+    void format(const SchedEvent& e, string& out) {
+        if (e.type == EVENT_BOOST_RESET && !(e.flags & (EVENT_RUNNING | EVENT_BLOCKED))) {
+            if (e.queue != reset_queue) {
+                end_reset_line(out);
+                add(out, "  Q", e.queue);
+                add(out, " -> Reset: P", e.pid);
+                reset_queue = e.queue;
+            } else {
+                add(out, ", P", e.pid);
+            }
+            return;
         }
-        
-        cout << "Queue Usage Statistics:\n";
-        for (int q = 0; q < config.num_queues; q++) {
-            cout << "  Q" << q << " (" << config.algo_names[q] << "): " 
-                 << queue_usage[q] << " time units ("
-                 << fixed << setprecision(1) << (100.0 * queue_usage[q] / total_busy_time)
-                 << "%)\n";
+        end_reset_line(out);
+        if (in_boost && e.type != EVENT_BOOST_RESET) {
+            out += string(60, '=') + "\n\n";
+            in_boost = false;
         }
-        cout << "\n";
         
-        cout << "Process-wise Metrics:\n";
-        cout << "PID\tArrival\tBurst\tInitPrio\tStart\tCompletion\tTAT\tWT\n";
-        cout << "---\t-------\t-----\t--------\t-----\t----------\t---\t--\n";
+        string continues;
+        switch (e.type) {
+        case EVENT_ARRIVAL:
+            add(out, "Time ", e.time);
+            add(out, ": Process P", e.pid);
+            if (e.queue == -1) {
+                out += " arrived with no CPU burst (completed)\n";
+                break;
+            }
+            add(out, " arrived -> Q", e.queue);
+            if (e.arg > 0) {
+                add(out, " (initial priority: ", e.arg);
+                out += ")";
+            }
+            out += "\n";
+            break;
         
-        double total_turnaround = 0.0, total_waiting = 0.0;
-        int last_completion = 0;
+        case EVENT_DISPATCH:
+            add(out, "Time ", e.time);
+            add(out, ": Process P", e.pid);
+            if (e.flags & EVENT_FIRST) {
+                add(out, " starts execution in Q", e.queue);
+                out += " (first time)\n";
+            } else {
+                add(out, " resumes execution in Q", e.queue);
+                out += "\n";
+            }
+            break;
         
-        for (auto& p : all_processes) {
-            int tat = p.completion - p.arrival;
-            int wt = tat - p.burst;
-            
-            cout << p.pid << "\t" << p.arrival << "\t" << p.burst << "\t"
-                 << p.initial_priority << "\t\t" << p.start_time << "\t" 
-                 << p.completion << "\t\t" << tat << "\t" << wt << "\n";
-            
-            total_turnaround += tat;
-            total_waiting += wt;
-            last_completion = max(last_completion, p.completion);
-        }
+        case EVENT_PREEMPTION:
+            add(out, "Time ", e.time);
+            add(out, ": Process P", e.pid);
+            add(out, " preempted in Q", e.queue);
+            add_next(out, e, " will run", "\n");
+            break;
         
-        Metrics m = get_metrics();
-        cout << "\n========================================\n";
-        cout << "Overall Performance Metrics\n";
-        cout << "========================================\n";
-        m.display("MLFQ");
+        case EVENT_DEMOTION:
+            add(out, "Time ", e.time);
+            add(out, ": Process P", e.pid);
+            if (e.to_queue != e.queue) {
+                add(out, " demoted Q", e.queue);
+                add(out, " -> Q", e.to_queue);
+                out += " (Quantum exhausted)";
+            } else {
+                add(out, " quantum exhausted in Q", e.queue);
+                add(out, " (stays in Q", e.queue);
+                out += ")";
+            }
+            continues = " -> P" + to_string(e.pid) + " continues in Q" + to_string(e.to_queue) + "\n";
+            add_next(out, e, " will run", continues);
+            break;
         
-        print_gantt_chart();
-        save_to_file();
-    }
-    
-    void print_gantt_chart() {
-        if (timeline_pid.empty()) return;
+        case EVENT_AGING:
+            add(out, "Time ", e.time);
+            add(out, ": Process P", e.pid);
+            add(out, " promoted Q", e.queue);
+            add(out, " -> Q", e.to_queue);
+            out += " (Aging)";
+            if (e.flags & EVENT_RUNNING) {
+                add(out, " [P", e.other_pid);
+                add(out, " currently running in Q", e.other_queue);
+                out += "]\n";
+            } else {
+                add(out, " [Will get CPU time in Q", e.to_queue);
+                out += "]\n";
+            }
+            break;
         
-        cout << "\n========================================\n";
-        cout << "Gantt Chart\n";
-        cout << "========================================\n";
+        case EVENT_BOOST:
+            out += "\n" + string(60, '=') + "\n";
+            add(out, "Time ", e.time);
+            out += ": PRIORITY BOOST - All processes reset to initial priority\n";
+            out += string(60, '=') + "\n";
+            in_boost = true;
+            break;
         
-        int cur_pid = timeline_pid[0];
-        int cur_queue = timeline_queue[0];
-        int start = 0;
+        case EVENT_BOOST_RESET:
+            add(out, (e.flags & EVENT_RUNNING) ? "  Running: P" : "  Blocked: P", e.pid);
+            add(out, " reset from Q", e.queue);
+            add(out, " to Q", e.to_queue);
+            out += "\n";
+            break;
         
-        for (size_t i = 1; i <= timeline_pid.size(); i++) {
-            if (i == timeline_pid.size() || 
-                timeline_pid[i] != cur_pid || 
-                timeline_queue[i] != cur_queue) {
-                
-                if (cur_pid == 0) {
-                    cout << "[Idle] " << start << "->" << i << "\n";
-                } else {
-                    cout << "P" << cur_pid << " [Q" << cur_queue << "] " 
-                         << start << "->" << i << "\n";
-                }
-                
-                if (i < timeline_pid.size()) {
-                    cur_pid = timeline_pid[i];
-                    cur_queue = timeline_queue[i];
-                    start = i;
-                }
+        case EVENT_COMPLETION:
+            add(out, "Time ", e.time);
+            add(out, ": Process P", e.pid);
+            add(out, " completed in Q", e.queue);
+            if (e.flags & EVENT_IDLE_NEXT) continues = " -> CPU will be idle\n";
+            else if (e.flags & EVENT_ALL_DONE) continues = " -> All processes completed\n";
+            else continues = "\n";
+            add_next(out, e, " will run next", continues);
+            break;
+        
+        case EVENT_IDLE:
+            add(out, "Time ", e.time);
+            out += (e.flags & EVENT_BLOCKED) ? ": CPU Idle (waiting for I/O or arrivals)\n" 
+                                             : ": CPU Idle (waiting for arrivals)\n";
+            break;
+        
+        case EVENT_BLOCK:
+            add(out, "Time ", e.time);
+            add(out, ": Process P", e.pid);
+            add(out, " blocked for I/O (", e.arg);
+            out += " units)";
+            if (e.to_queue != e.queue) {
+                add(out, ", demoted Q", e.queue);
+                add(out, " -> Q", e.to_queue);
+                out += " (Quantum exhausted)";
+            } else {
+                add(out, ", keeps Q", e.queue);
             }
-        }
+            continues = (e.flags & EVENT_IDLE_NEXT) ? " -> CPU will be idle\n" : "\n";
+            add_next(out, e, " will run next", continues);
+            break;
         
-        int limit = min(100, (int)timeline_pid.size());
-        cout << "\nDetailed Timeline (first " << limit << " units):\n";
-        cout << "Time: ";
-        for (int i = 0; i < limit; i++) {
-            cout << setw(3) << i;
+        case EVENT_WAKE:
+            add(out, "Time ", e.time);
+            add(out, ": Process P", e.pid);
+            add(out, " I/O done -> Q", e.queue);
+            out += "\n";
+            break;
         }
-        if (timeline_pid.size() > (size_t)limit) cout << " ...";
-        
-        cout << "\nProc: ";
-        for (int i = 0; i < limit; i++) {
-            if (timeline_pid[i] == 0) cout << "  -";
-            else cout << " P" << timeline_pid[i];
+    }
+    
+    // Close any open boost output
+    void finish(string& out) {
+        end_reset_line(out);
+        if (in_boost) {
+            out += string(60, '=') + "\n\n";
+            in_boost = false;
         }
-        if (timeline_pid.size() > (size_t)limit) cout << " ...";
-        
-        cout << "\nQueue:";
-        for (int i = 0; i < limit; i++) {
-            if (timeline_queue[i] == -1) cout << "  -";
-            else cout << " Q" << timeline_queue[i];
+    }
+};
+
+// Discards events; with it every logging branch is compiled out
+struct NullSink {
+    static constexpr bool enabled = false;
+    void emit(const SchedEvent&) {}
+    void flush() {}
+};
+
+// Formats each event as it happens into a text buffer that is written to
+// stdout in large blocks
+class TextSink {
+private:
+    EventFormatter formatter;
+    string text;
+
+public:
+    static constexpr bool enabled = true;
+    
+    TextSink() { text.reserve(1 << 17); }
+    
+    void emit(const SchedEvent& e) {
+        formatter.format(e, text);
+        if (text.size() >= (1 << 16)) {
+            cout.write(text.data(), text.size());
+            text.clear();
         }
-        if (timeline_queue.size() > (size_t)limit) cout << " ...";
-        cout << "\n";
     }
     
-    void save_to_file() {
-        ofstream fout("mlfq_results.txt");
-        Metrics m = get_metrics();
-        
-        fout << "MLFQ Scheduler Results\n";
-        fout << "======================\n\n";
-        
-        fout << "Configuration:\n";
-        fout << "Number of Queues: " << config.num_queues << "\n";
-        for (int i = 0; i < config.num_queues; i++) {
-            fout << "Q" << i << ": " << config.algo_names[i];
-            if (config.time_quantum[i] > 0) {
-                fout << " (TQ=" << config.time_quantum[i] << ")";
-            }
-            fout << "\n";
+    void flush() {
+        formatter.finish(text);
+        cout.write(text.data(), text.size());
+        text.clear();
+    }
+};
+
+// Copies events into a preallocated buffer and formats them in batches when
+// it fills up and at the end of the run, away from the simulation loop
+class BufferSink {
+private:
+    vector<SchedEvent> events;
+    size_t count;
+    EventFormatter formatter;
+    string text;
+    
+    void drain() {
+        for (size_t i = 0; i < count; i++) {
+            formatter.format(events[i], text);
         }
-        fout << "\n";
-        
-        fout << "Performance Metrics:\n";
-        fout << "Average Turnaround Time: " << m.avg_turnaround << "\n";
-        fout << "Average Waiting Time: " << m.avg_waiting << "\n";
+        count = 0;
+        cout.write(text.data(), text.size());
+        text.clear();
+    }
+
+public:
+    static constexpr bool enabled = true;
+    
+    explicit BufferSink(size_t capacity = 1 << 16) : events(capacity), count(0) {}
+    
+    void emit(const SchedEvent& e) {
+        events[count++] = e;
+        if (count == events.size()) drain();
+    }
+    
+    void flush() {
+        drain();
+        formatter.finish(text);
+        cout.write(text.data(), text.size());
+        text.clear();
+    }
+};
+
+// Sink of verbose runs: -DMLFQ_LOG_NONE drops the event log (benchmark
+// builds), -DMLFQ_LOG_TEXT formats every event immediately, and by default
+// events are buffered and formatted in batches
+#if defined(MLFQ_LOG_NONE)
+typedef NullSink VerboseSink;
+#elif defined(MLFQ_LOG_TEXT)
+typedef TextSink VerboseSink;
+#else
+typedef BufferSink VerboseSink;
+#endif
+
+// Binary event log, written with --events and read back with --read-events.
+// Host byte order:
+//   header (32 bytes): magic "MLFQEVT1", version, record size, record count
+//   SchedEvent records (32 bytes each) in the order they happened
+const char EVENT_LOG_MAGIC[8] = {'M', 'L', 'F', 'Q', 'E', 'V', 'T', '1'};
+const uint32_t EVENT_LOG_VERSION = 1;
+
+struct EventLogHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t count;
+    uint64_t reserved;
+};
+
+static_assert(sizeof(SchedEvent) == 32, "event log records are 32 bytes");
+
+// Sink that appends events to a binary event log. Records are collected
+// in a buffer and written in blocks; close() fills in the header count.
+class EventLogWriter {
+private:
+    ofstream fout;
+    vector<SchedEvent> buffer;
+    uint64_t count;
+    
+    void write_header() {
+        EventLogHeader h;
+        memcpy(h.magic, EVENT_LOG_MAGIC, sizeof(EVENT_LOG_MAGIC));
+        h.version = EVENT_LOG_VERSION;
+        h.record_size = sizeof(SchedEvent);
+        h.count = count;
+        h.reserved = 0;
+        fout.write((const char*)&h, sizeof(h));
+    }
+
+public:
+    static constexpr bool enabled = true;
+    
+    EventLogWriter() : count(0) { buffer.reserve(1 << 15); }
+    
+    bool open(const string& filename) {
+        fout.open(filename, ios::binary);
+        if (!fout) return false;
+        count = 0;
+        write_header();
+        return (bool)fout;
+    }
+    
+    void emit(const SchedEvent& e) {
+        buffer.push_back(e);
+        if (buffer.size() == buffer.capacity()) flush();
+    }
+    
+    void flush() {
+        fout.write((const char*)buffer.data(), buffer.size() * sizeof(SchedEvent));
+        count += buffer.size();
+        buffer.clear();
+    }
+    
+    bool close() {
+        flush();
+        fout.seekp(0);
+        write_header();
+        fout.close();
+        return (bool)fout;
+    }
+    
+    uint64_t events_written() const { return count; }
+};
+
+// Sends every event to two sinks
+template <class A, class B>
+struct TeeSink {
+    static constexpr bool enabled = A::enabled || B::enabled;
+    
+    A& first;
+    B& second;
+    
+    TeeSink(A& a, B& b) : first(a), second(b) {}
+    
+    void emit(const SchedEvent& e) {
+        if (A::enabled) first.emit(e);
+        if (B::enabled) second.emit(e);
+    }
+    
+    void flush() {
+        first.flush();
+        second.flush();
+    }
+};
+
+// ==================== SCHEDULER INTERFACE ====================
+// Implemented by MLFQ and every comparison scheduler. run() simulates the
+// whole workload once and returns its metrics.
+class Scheduler {
+public:
+    virtual ~Scheduler() {}
+    
+    // Short name used in results files ("RR"); full_name() for tables
+    virtual string name() const = 0;
+    virtual string full_name() const { return name(); }
+    
+    virtual Metrics run() = 0;
+};
+
+// ==================== LEVEL POLICIES ====================
+// Decide which process in an MLFQ ready queue runs next. Each queue keeps
+// its processes in a ReadyList in queue order (used by aging and boosts);
+// the level's policy only picks from it. The quantum still comes from the
+// level's time quantum. A policy provides:
+//   on_enqueue(p)  p has joined the level
+//   pick(list)     next process to run from the non-empty list; no side
+//                  effects, so peeking and dispatching agree
+//   on_dispatch()  the picked process has left the level to run
+//   clear()        every process has left the level (priority boost)
+
+// RR and FCFS: queue order
+struct FifoPolicy {
+    void on_enqueue(Process*) {}
+    Process* pick(ReadyList& list) { return list.front(); }
+    void on_dispatch() {}
+    void clear() {}
+};
+
+// Smallest Key::of(p) first, ties in queue order. Like the aging index,
+// entries of processes that left the level are dropped lazily.
+template <class Key>
+struct KeyedPolicy {
+    struct Entry {
+        long long key;
+        long long pos;
+        Process* p;
+        
+        bool operator>(const Entry& other) const {
+            return key > other.key || (key == other.key && pos > other.pos);
+        }
+    };
+    
+    int level;
+    vector<Entry> heap;     // Min-heap on (key, pos)
+    
+    explicit KeyedPolicy(int q) : level(q) {}
+    
+    void on_enqueue(Process* p) {
+        heap.push_back({Key::of(p), p->queue_pos, p});
+        push_heap(heap.begin(), heap.end(), greater<Entry>());
+    }
+    
+    Process* pick(ReadyList&) {
+        while (heap.front().p->priority != level || heap.front().p->queue_pos != heap.front().pos) {
+            pop_heap(heap.begin(), heap.end(), greater<Entry>());
+            heap.pop_back();
+        }
+        return heap.front().p;
+    }
+    
+    void on_dispatch() {}
+    void clear() { heap.clear(); }
+};
+
+// SJF: least remaining CPU time
+struct RemainingKey {
+    static long long of(const Process* p) { return p->remaining; }
+};
+
+// Priority: lowest initial priority number
+struct InitialPriorityKey {
+    static long long of(const Process* p) { return p->initial_priority; }
+};
+
+typedef KeyedPolicy<RemainingKey> SJFPolicy;
+typedef KeyedPolicy<InitialPriorityKey> PriorityPolicy;
+
+// Lottery: the winning ticket is drawn when the previous winner is
+// dispatched, and pick() finds its holder, so a run is reproducible and
+// the same whether or not it is logged. A process holds one ticket per
+// level at or below its initial priority.
+struct LotteryPolicy {
+    int num_levels;
+    mt19937 rng;
+    uint32_t draw;
+    
+    LotteryPolicy(int q, int levels) : num_levels(levels), rng(q + 1) {
+        draw = rng();
+    }
+    
+    int tickets(const Process* p) const {
+        return num_levels - max(0, min(p->initial_priority, num_levels - 1));
+    }
+    
+    void on_enqueue(Process*) {}
+    
+    Process* pick(ReadyList& list) {
+        long long total = 0;
+        for (Process* p = list.front(); p != nullptr; p = p->next) {
+            total += tickets(p);
+        }
+        long long ticket = draw % total;
+        Process* p = list.front();
+        while ((ticket -= tickets(p)) >= 0) {
+            p = p->next;
+        }
+        return p;
+    }
+    
+    void on_dispatch() { draw = rng(); }
+    void clear() {}
+};
+
+typedef variant<FifoPolicy, SJFPolicy, PriorityPolicy, LotteryPolicy> LevelPolicy;
+
+// Policy named by a config.txt algorithm name. RR, FCFS and unrecognised
+// names keep queue order.
+LevelPolicy make_level_policy(const string& algo_name, int q, int num_queues) {
+    string name = algo_name;
+    transform(name.begin(), name.end(), name.begin(), ::tolower);
+    if (name.find("sjf") != string::npos || name.find("shortest") != string::npos) {
+        return SJFPolicy(q);
+    }
+    if (name.find("prio") != string::npos) return PriorityPolicy(q);
+    if (name.find("lottery") != string::npos) return LotteryPolicy(q, num_queues);
+    return FifoPolicy();
+}
+
+// ==================== TIMER WHEEL ====================
+// Hierarchical timing wheel of values due at integer times: six levels of
+// 64 slots, level L covering 64^L time units per slot. A timer sits at the
+// level of the highest 6-bit digit in which its time differs from the
+// wheel's clock and moves down a level when the clock reaches its slot, so
+// insertion is O(1) and every timer moves at most five times before it
+// expires. Timers due at the same time expire in insertion order.
+template <class T>
+class TimerWheel {
+private:
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+    static const int LEVELS = 6;        // 36 bits: all of 32-bit time
+    
+    struct Timer {
+        int when;
+        T value;
+    };
+    
+    vector<vector<Timer>> slots;        // LEVELS * SLOTS, level-major
+    vector<int> slot_min;               // Earliest time in each slot
+    uint64_t occupied[LEVELS];          // Bit s of level L set <=> slot non-empty
+    vector<Timer> due;                  // Scratch for expire(), reused
+    int now;
+    size_t count;
+    
+    static int level_of(int when, int clock) {
+        unsigned diff = (unsigned)when ^ (unsigned)clock;
+        return diff == 0 ? 0 : (31 - __builtin_clz(diff)) / SLOT_BITS;
+    }
+    
+    void place(const Timer& t) {
+        int level = level_of(t.when, now);
+        int s = (t.when >> (level * SLOT_BITS)) & (SLOTS - 1);
+        int i = level * SLOTS + s;
+        if (slots[i].empty()) {
+            slot_min[i] = t.when;
+            occupied[level] |= (uint64_t)1 << s;
+        } else {
+            slot_min[i] = min(slot_min[i], t.when);
+        }
+        slots[i].push_back(t);
+    }
+    
+    // Move the clock forward to t, which must not be after any timer, and
+    // bring down the timers of every slot the clock has entered
+    void set_now(int t) {
+        now = t;
+        for (int level = LEVELS - 1; level > 0; level--) {
+            int s = (t >> (level * SLOT_BITS)) & (SLOTS - 1);
+            if (!(occupied[level] >> s & 1)) continue;
+            occupied[level] &= ~((uint64_t)1 << s);
+            due.swap(slots[level * SLOTS + s]);
+            for (auto& timer : due) {
+                place(timer);
+            }
+            due.clear();
+        }
+    }
+    
+public:
+    TimerWheel() : slots(LEVELS * SLOTS), slot_min(LEVELS * SLOTS), now(0), count(0) {
+        fill(occupied, occupied + LEVELS, 0);
+    }
+    
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    
+    // Add a timer; one for a time already passed is due at the wheel's clock
+    void insert(int when, const T& value) {
+        place({max(when, now), value});
+        count++;
+    }
+    
+    // Time of the earliest timer, INT_MAX if there is none. Slots below the
+    // clock's own are empty at every level, so the first occupied slot of
+    // the lowest occupied level holds it.
+    int next_expiry() const {
+        if (count == 0) return INT_MAX;
+        for (int level = 0; level < LEVELS; level++) {
+            if (occupied[level] != 0) {
+                return slot_min[level * SLOTS + __builtin_ctzll(occupied[level])];
+            }
+        }
+        return INT_MAX;
+    }
+    
+    // Remove every timer due at or before t, calling f(value) for each in
+    // time order, and move the clock to t. f may insert new timers.
+    template <class F>
+    void expire(int t, F f) {
+        while (next_expiry() <= t) {
+            int when = next_expiry();
+            set_now(when);
+            int s = when & (SLOTS - 1);
+            occupied[0] &= ~((uint64_t)1 << s);
+            due.swap(slots[s]);
+            count -= due.size();
+            for (auto& timer : due) {
+                f(timer.value);
+            }
+            due.clear();
+        }
+        if (count == 0) now = max(now, t);
+        else if (t > now) set_now(t);
+    }
+    
+    // Drop the timers due at or before t for which stale(value) holds,
+    // stopping at the first one that is not
+    template <class Pred>
+    void discard_front(int t, Pred stale) {
+        while (next_expiry() <= t) {
+            int when = next_expiry();
+            set_now(when);
+            int s = when & (SLOTS - 1);
+            vector<Timer>& slot = slots[s];
+            size_t kept = 0;
+            for (size_t i = 0; i < slot.size(); i++) {
+                if (!stale(slot[i].value)) slot[kept++] = slot[i];
+            }
+            count -= slot.size() - kept;
+            slot.resize(kept);
+            if (kept > 0) return;
+            occupied[0] &= ~((uint64_t)1 << s);
+        }
+    }
+    
+    template <class F>
+    void for_each(F f) const {
+        for (int level = 0; level < LEVELS; level++) {
+            for (uint64_t bits = occupied[level]; bits != 0; bits &= bits - 1) {
+                for (auto& timer : slots[level * SLOTS + __builtin_ctzll(bits)]) {
+                    f(timer.value);
+                }
+            }
+        }
+    }
+};
+
+// ==================== MLFQ SCHEDULER CLASS ====================
+class MLFQ_Scheduler : public Scheduler {
+private:
+    // Aging timer of a process queued at `level`, due when it reaches
+    // aging_threshold. Timers are not removed when the process leaves the
+    // queue; they are recognised as stale by their position key and
+    // dropped lazily.
+    struct AgingEntry {
+        long long pos;
+        Process* p;
+        int level;
+    };
+    
+    vector<Process> all_processes;
+    deque<Process*> pending;        // Not-yet-admitted processes in arrival order
+    ProcessSource* trace;           // Streaming mode: processes come from here instead
+    deque<Process> process_pool;    // Streaming mode: storage for live processes,
+    vector<Process*> free_processes;    // recycled once they complete
+    bool recycle;                   // Completed processes go to free_processes
+    vector<ReadyList> queues;
+    vector<LevelPolicy> policies;   // Picks the next process of each queue
+    vector<uint64_t> occupied;      // Bit q set <=> queues[q] is non-empty
+    vector<long long> front_pos;    // Position keys: decrease at the front, increase at the back,
+    vector<long long> back_pos;     // so keys stay sorted along each queue
+    TimerWheel<AgingEntry> aging_timers;    // Keyed on aging deadline
+    vector<Process*> promoted;      // Scratch for apply_aging(), reused across checks
+    TimerWheel<Process*> blocked;   // Processes waiting for I/O, keyed on wake time
+    Config config;
+    int current_time;
+    int admitted;
+    int completed;
+    int total_busy_time;
+    int context_switches;
+    MetricsAccumulator totals;      // Summed as processes complete
+    LatencyReport latency;
+    vector<TimelineSegment> timeline;   // Run-length encoded, one entry per state change
+    bool keep_timeline;             // Off in streaming mode: memory must not grow with the trace
+    vector<int> queue_usage;        // Time units executed in each queue
+    Process* currently_running;
+    EventLogWriter* event_log;      // Binary copy of the events, if requested
+    bool verbose_mode;
+    bool logging;                   // Events go to a sink: stop at every boost to log it
+    
+public:
+    MLFQ_Scheduler(const vector<Process>& procs, const Config& cfg) {
+        all_processes = procs;
+        trace = nullptr;
+        init(cfg);
+        
+        // Admission order: by arrival, ties in input order. main() already
+        // sorts its input, so the sort is usually skipped.
+        for (auto& p : all_processes) {
+            pending.push_back(&p);
+        }
+        auto by_arrival = [](const Process* a, const Process* b) {
+            return a->arrival < b->arrival;
+        };
+        if (!is_sorted(pending.begin(), pending.end(), by_arrival)) {
+            stable_sort(pending.begin(), pending.end(), by_arrival);
+        }
+    }
+    
+    // Streaming mode: processes are pulled from the trace as simulated time
+    // reaches their arrival and released when they complete, so memory is
+    // bounded by the live set. No per-process results or timeline are kept.
+    MLFQ_Scheduler(ProcessSource& source, const Config& cfg) {
+        trace = &source;
+        init(cfg);
+        keep_timeline = false;
+        recycle = true;
+    }
+    
+    // One CPU of an SMP_Scheduler, which allocates the processes: they are
+    // handed in with assign() and adopt(), and the slots of those that
+    // completed or were stolen come back through reuse_slot(). A slot is
+    // only reused on the CPU that freed it, because stale index entries
+    // there may still point at it; so a CPU never touches another CPU's
+    // processes and CPUs can be simulated in parallel. No per-process
+    // results or timeline are kept.
+    explicit MLFQ_Scheduler(const Config& cfg) {
+        trace = nullptr;
+        init(cfg);
+        keep_timeline = false;
+        recycle = true;
+    }
+    
+private:
+    void init(const Config& cfg) {
+        config = cfg;
+        
+        queues.resize(config.num_queues);
+        for (int q = 0; q < config.num_queues; q++) {
+            policies.push_back(make_level_policy(config.algo_names[q], q, config.num_queues));
+        }
+        occupied.assign((config.num_queues + 63) / 64, 0);
+        front_pos.assign(config.num_queues, 0);
+        back_pos.assign(config.num_queues, 0);
+        
+        current_time = 0;
+        admitted = 0;
+        completed = 0;
+        total_busy_time = 0;
+        context_switches = 0;
+        keep_timeline = true;
+        recycle = false;
+        queue_usage.assign(config.num_queues, 0);
+        latency.reset(config.num_queues);
+        currently_running = nullptr;
+        event_log = nullptr;
+        verbose_mode = true;
+        logging = false;
+    }
+    
+    bool has_pending_arrivals() {
+        if (trace != nullptr) return !trace->empty();
+        return !pending.empty();
+    }
+    
+    // Earliest time at which a not-yet-admitted process arrives (INT_MAX if none)
+    int next_arrival_time() {
+        if (!has_pending_arrivals()) return INT_MAX;
+        if (trace != nullptr) return trace->peek().arrival;
+        return pending.front()->arrival;
+    }
+    
+    // Whether any not-yet-admitted process arrives after time t
+    bool has_arrival_after(int t) {
+        if (trace != nullptr) return trace->has_arrival_after(t);
+        // The last one in arrival order is the latest
+        return has_pending_arrivals() && pending.back()->arrival > t;
+    }
+    
+    Process* take_next_arrival() {
+        if (trace == nullptr) {
+            Process* p = pending.front();
+            pending.pop_front();
+            return p;
+        }
+        
+        ProcessOriginal o = trace->next();
+        Process* p;
+        if (!free_processes.empty()) {
+            p = free_processes.back();
+            free_processes.pop_back();
+            *p = Process(o.pid, o.arrival, o.burst, o.initial_priority, o.bursts);
+        } else {
+            process_pool.emplace_back(o.pid, o.arrival, o.burst, o.initial_priority, o.bursts);
+            p = &process_pool.back();
+        }
+        return p;
+    }
+    
+    // Account a completed process; in streaming mode its slot is reused
+    void retire(Process* p) {
+        completed++;
+        totals.add(*p);
+        latency.add(*p, initial_level(p));
+        if (recycle) free_processes.push_back(p);
+    }
+    
+public:
+    
+    // Put p into the ready queue of its current priority. The caller sets
+    // enqueue_time and time_in_queue first; they determine the aging deadline.
+    void enqueue(Process* p, bool at_front = false) {
+        int q = p->priority;
+        if (at_front) {
+            p->queue_pos = --front_pos[q];
+            queues[q].push_front(p);
+        } else {
+            p->queue_pos = ++back_pos[q];
+            queues[q].push_back(p);
+        }
+        visit([p](auto& policy) { policy.on_enqueue(p); }, policies[q]);
+        occupied[q / 64] |= (uint64_t)1 << (q % 64);
+        if (q > 0) {
+            // Past 32-bit time the process never ages: a huge threshold
+            // turns aging off
+            long long deadline = (long long)p->enqueue_time + config.aging_threshold - p->time_in_queue;
+            if (deadline < INT_MAX) {
+                aging_timers.insert((int)max(deadline, 0LL), {p->queue_pos, p, q});
+            }
+        }
+    }
+    
+    // Process the policy of queue q would run next (queue must be non-empty)
+    Process* next_in_queue(int q) {
+        return visit([this, q](auto& policy) { return policy.pick(queues[q]); }, policies[q]);
+    }
+    
+    Process* dequeue_next(int q) {
+        Process* p = next_in_queue(q);
+        queues[q].remove(p);
+        visit([](auto& policy) { policy.on_dispatch(); }, policies[q]);
+        p->queue_pos = 0;
+        update_occupied(q);
+        return p;
+    }
+    
+    void update_occupied(int q) {
+        if (queues[q].empty()) {
+            occupied[q / 64] &= ~((uint64_t)1 << (q % 64));
+        }
+    }
+    
+    // First non-empty queue at level >= from, or -1. One find-first-set per
+    // 64 levels.
+    int next_occupied(int from) const {
+        if (from >= config.num_queues) return -1;
+        size_t w = from / 64;
+        uint64_t bits = occupied[w] & (~(uint64_t)0 << (from % 64));
+        while (bits == 0) {
+            if (++w == occupied.size()) return -1;
+            bits = occupied[w];
+        }
+        return w * 64 + __builtin_ctzll(bits);
+    }
+    
+    // Queue level of a process's initial priority, clamped to valid range
+    int initial_level(const Process* p) const {
+        return max(0, min(p->initial_priority, config.num_queues - 1));
+    }
+    
+    bool is_live(const AgingEntry& e) const {
+        return e.p->priority == e.level && e.p->queue_pos == e.pos;
+    }
+    
+    template <class Sink>
+    void add_arrivals(Sink& sink) {
+        while (next_arrival_time() <= current_time) {
+            Process& p = *take_next_arrival();
+            admitted++;
+            
+            // Nothing to run: completes on arrival and never enters a queue
+            if (p.remaining <= 0) {
+                p.started = true;
+                p.start_time = current_time;
+                p.completion = current_time;
+                if (Sink::enabled) {
+                    sink.emit(make_event(EVENT_ARRIVAL, current_time, p.pid, -1));
+                }
+                retire(&p);
+                continue;
+            }
+            
+            // Validate and clamp initial priority to valid range
+            p.priority = initial_level(&p);
+            
+            // Place in queue based on initial priority
+            p.enqueue_time = current_time;
+            enqueue(&p);
+            
+            if (Sink::enabled) {
+                SchedEvent e = make_event(EVENT_ARRIVAL, current_time, p.pid, p.priority);
+                e.arg = p.initial_priority;
+                sink.emit(e);
+            }
+        }
+    }
+    
+    // Earliest time a blocked process finishes its I/O (INT_MAX if none)
+    int next_wake_time() const {
+        return blocked.next_expiry();
+    }
+    
+    // The running process finished a CPU burst and has I/O next. Giving up
+    // the CPU before its quantum expires keeps its level; if the burst used
+    // up the quantum it is demoted as usual. With allotment accounting the
+    // CPU used so far stays charged to the level, so a process that always
+    // blocks just before expiry is still demoted once its bursts add up.
+    template <class Sink>
+    void block_running(Sink& sink) {
+        Process* p = currently_running;
+        int old_queue = p->priority;
+        int tq = config.time_quantum[old_queue];
+        bool exhausted = tq > 0 && p->time_in_current_quantum >= tq;
+        if (exhausted && p->priority < config.num_queues - 1) {
+            p->priority++;
+        }
+        if (exhausted || !config.allotment) p->time_in_current_quantum = 0;
+        
+        int io = p->bursts[p->phase];
+        p->remaining = p->bursts[p->phase + 1];
+        p->phase += 2;
+        int wake = current_time + 1 + io;
+        p->enqueue_time = current_time + 1;
+        blocked.insert(wake, p);
+        currently_running = nullptr;
+        
+        if (Sink::enabled) {
+            SchedEvent e = make_event(EVENT_BLOCK, current_time + 1, p->pid, old_queue);
+            e.to_queue = p->priority;
+            e.arg = io;
+            set_next(e);
+            if (e.other_pid == 0 && min(next_arrival_time(), next_wake_time()) > current_time + 1) {
+                e.flags = EVENT_IDLE_NEXT;
+            }
+            sink.emit(e);
+        }
+    }
+    
+    // Ready every blocked process whose I/O has finished, in wake order.
+    // Boosts reset blocked processes only now, so they never touch the
+    // blocked set. As for the running process, a boost only raises a
+    // blocked process to its initial priority and never lowers it.
+    template <class Sink>
+    void wake_blocked(Sink& sink) {
+        blocked.expire(current_time, [this, &sink](Process* p) {
+            if (p->priority > initial_level(p) && boosted_between(p->enqueue_time, current_time - 1)) {
+                p->priority = initial_level(p);
+                p->time_in_current_quantum = 0;
+            }
+            p->time_in_queue = 0;
+            p->enqueue_time = current_time;
+            enqueue(p);
+            
+            if (Sink::enabled) {
+                sink.emit(make_event(EVENT_WAKE, current_time, p->pid, p->priority));
+            }
+        });
+    }
+    
+    // Promote every process that has waited at least aging_threshold. Only
+    // the aging timers that are due are touched; promoted processes keep
+    // their relative queue order.
+    template <class Sink>
+    void apply_aging(Sink& sink) {
+        promoted.clear();
+        aging_timers.expire(current_time, [this](const AgingEntry& e) {
+            if (is_live(e)) promoted.push_back(e.p);
+        });
+        if (promoted.empty()) return;
+        
+        // Level by level from the top, in queue order within a level
+        sort(promoted.begin(), promoted.end(), [](Process* a, Process* b) {
+            return a->priority != b->priority ? a->priority < b->priority : a->queue_pos < b->queue_pos;
+        });
+        
+        for (size_t begin = 0, end = 0; begin < promoted.size(); begin = end) {
+            int q = promoted[begin]->priority;
+            while (end < promoted.size() && promoted[end]->priority == q) {
+                queues[q].remove(promoted[end++]);
+            }
+            update_occupied(q);
+            
+            for (size_t i = begin; i < end; i++) {
+                Process* p = promoted[i];
+                if (Sink::enabled) {
+                    SchedEvent e = make_event(EVENT_AGING, current_time, p->pid, q);
+                    e.to_queue = q - 1;
+                    if (currently_running != nullptr) {
+                        e.flags = EVENT_RUNNING;
+                        e.other_pid = currently_running->pid;
+                        e.other_queue = currently_running->priority;
+                    }
+                    sink.emit(e);
+                }
+                
+                // Promote to higher priority queue
+                p->priority = q - 1;
+                p->time_in_queue = 0;
+                p->enqueue_time = current_time;
+                p->time_in_current_quantum = 0;
+                enqueue(p);
+            }
+        }
+    }
+    
+    template <class Sink>
+    void apply_priority_boost(Sink& sink) {
+        if (Sink::enabled) {
+            sink.emit(make_event(EVENT_BOOST, current_time, 0, -1));
+        }
+        
+        ReadyList all_waiting;
+        
+        // Collect processes from all queues except Q0
+        for (int q = next_occupied(1); q != -1; q = next_occupied(q + 1)) {
+            for (Process* p = queues[q].front(); p != nullptr; p = p->next) {
+                if (Sink::enabled && initial_level(p) != q) {
+                    SchedEvent e = make_event(EVENT_BOOST_RESET, current_time, p->pid, q);
+                    e.to_queue = initial_level(p);
+                    sink.emit(e);
+                }
+                
+                // Reset to initial priority (respects original importance)
+                p->priority = initial_level(p);
+                p->time_in_queue = 0;
+                p->enqueue_time = current_time;
+                p->time_in_current_quantum = 0;
+            }
+            all_waiting.append(queues[q]);
+            visit([](auto& policy) { policy.clear(); }, policies[q]);
+            update_occupied(q);
+        }
+        
+        // Place processes in their initial priority queues
+        while (!all_waiting.empty()) {
+            enqueue(all_waiting.pop_front());
+        }
+        
+        // Blocked processes below their initial priority return to it when
+        // they wake (see wake_blocked()); the first boost they miss logs it
+        if (Sink::enabled) {
+            blocked.for_each([this, &sink](Process* p) {
+                if (p->priority > initial_level(p) && 
+                    !boosted_between(p->enqueue_time, current_time - 1)) {
+                    SchedEvent e = make_event(EVENT_BOOST_RESET, current_time, p->pid, p->priority);
+                    e.to_queue = initial_level(p);
+                    e.flags = EVENT_BLOCKED;
+                    sink.emit(e);
+                }
+            });
+        }
+        
+        // Reset currently running process if below initial priority
+        if (currently_running != nullptr && 
+            currently_running->priority > initial_level(currently_running)) {
+            if (Sink::enabled) {
+                SchedEvent e = make_event(EVENT_BOOST_RESET, current_time, 
+                                          currently_running->pid, currently_running->priority);
+                e.to_queue = initial_level(currently_running);
+                e.flags = EVENT_RUNNING;
+                sink.emit(e);
+            }
+            currently_running->priority = initial_level(currently_running);
+            currently_running->time_in_current_quantum = 0;
+        }
+    }
+    
+#ifdef MLFQ_DEBUG
+    // Debug builds (-DMLFQ_DEBUG) check the ready-queue invariants at every
+    // event: a process is queued at most once, in the queue of its current
+    // priority, with position keys increasing along the queue, the occupancy
+    // bitmap matches the queues, and no process is queued after it has
+    // completed (completion removes it exactly once).
+    void validate_queues() {
+        size_t queued = 0;
+        for (int q = 0; q < config.num_queues; q++) {
+            long long last_pos = LLONG_MIN;
+            for (Process* p = queues[q].front(); p != nullptr; p = p->next) {
+                assert(p != currently_running);
+                assert(p->remaining > 0 && p->completion == -1);
+                assert(p->priority == q);
+                assert(p->queue_pos != 0 && p->queue_pos > last_pos);
+                assert(p->next != nullptr ? p->next->prev == p : queues[q].tail == p);
+                last_pos = p->queue_pos;
+                queued++;
+            }
+            bool bit = (occupied[q / 64] >> (q % 64)) & 1;
+            assert(bit == !queues[q].empty());
+        }
+        blocked.for_each([this](Process* p) {
+            assert(p != currently_running && p->queue_pos == 0);
+            assert(p->remaining > 0 && p->completion == -1);
+        });
+        size_t running = (currently_running != nullptr) ? 1 : 0;
+        assert(queued + running + blocked.size() + completed == (size_t)admitted);
+    }
+#endif
+    
+    // Time a queued process has waited since it was last reset. Waiting is
+    // accounted lazily: only enqueue and dispatch touch the process.
+    int waiting_time(const Process* p) const {
+        return p->time_in_queue + (current_time - p->enqueue_time);
+    }
+    
+    // First aging check that may promote a waiting process. Stale timers
+    // can only be dropped up to now (the wheel's clock must not pass
+    // current_time), so a later stale one can cost a check that promotes
+    // nothing, which changes no scheduler state.
+    int next_aging_time() {
+        if (next_occupied(1) == -1) return INT_MAX;
+        aging_timers.discard_front(current_time, [this](const AgingEntry& e) { return !is_live(e); });
+        int deadline = aging_timers.next_expiry();
+        if (deadline == INT_MAX) return INT_MAX;
+        
+        long long due = max(current_time + 1, deadline);
+        long long interval = config.aging_check_interval;
+        return (int)min((long long)INT_MAX, (due + interval - 1) / interval * interval);
+    }
+    
+    // Whether a boost boundary falls in [from, to]
+    bool boosted_between(int from, int to) const {
+        return to >= from && to / config.boost_interval * config.boost_interval >= from;
+    }
+    
+    // Next boost boundary that changes scheduler state. A boost with nothing
+    // below Q0 and the running process at or above its initial priority is
+    // a no-op (blocked processes catch up when they wake), so it is skipped
+    // unless events are logged.
+    int next_boost_time() {
+        bool effective = logging || next_occupied(1) != -1 ||
+            (currently_running != nullptr && 
+             currently_running->priority > initial_level(currently_running));
+        if (!effective) return INT_MAX;
+        return (current_time / config.boost_interval + 1) * config.boost_interval;
+    }
+    
+    // Number of time units the running process can execute before anything
+    // else happens (arrival, aging promotion, boost, completion, quantum expiry)
+    int time_to_next_event() {
+        int slice = currently_running->remaining;
+        int tq = config.time_quantum[currently_running->priority];
+        if (tq > 0) {
+            slice = min(slice, max(1, tq - currently_running->time_in_current_quantum));
+        }
+        int next_event = min(min(next_arrival_time(), next_wake_time()), 
+                             min(next_aging_time(), next_boost_time()));
+        if (next_event != INT_MAX) {
+            slice = min(slice, next_event - current_time);
+        }
+        return max(1, slice);
+    }
+    
+    // Append `length` units starting at current_time, extending the last
+    // segment if the same process keeps running in the same queue
+    void record_timeline(int pid, int queue, int length) {
+        if (queue >= 0) queue_usage[queue] += length;
+        if (!keep_timeline) return;
+        if (!timeline.empty()) {
+            TimelineSegment& last = timeline.back();
+            if (last.pid == pid && last.queue == queue && 
+                last.start + last.length == current_time) {
+                last.length += length;
+                return;
+            }
+        }
+        timeline.push_back({pid, queue, current_time, length});
+    }
+    
+    int get_highest_priority_queue() {
+        return next_occupied(0);
+    }
+    
+    bool should_preempt(int running_queue) {
+        int q = next_occupied(0);
+        return q != -1 && q < running_queue;
+    }
+    
+    string name() const override { return "MLFQ"; }
+    
+    Metrics run() override {
+        run(false);
+        return get_metrics();
+    }
+    
+    void run(bool verbose) {
+        verbose_mode = verbose;
+        
+        if (verbose_mode) {
+            cout << "\n========================================\n";
+            cout << "MLFQ SCHEDULER \n";
+            cout << "========================================\n";
+            config.display();
+            cout << "========================================\n\n";
+            
+            VerboseSink sink;
+            simulate_logged(sink);
+            print_results();
+        } else {
+            NullSink sink;
+            simulate_logged(sink);
+        }
+    }
+    
+    // Write every event to `log` as well (nullptr: no event log)
+    void set_event_log(EventLogWriter* log) {
+        event_log = log;
+    }
+    
+private:
+    template <class Sink>
+    void simulate_logged(Sink& sink) {
+        if (event_log == nullptr) {
+            simulate(sink);
+        } else {
+            TeeSink<Sink, EventLogWriter> tee(sink, *event_log);
+            simulate(tee);
+        }
+    }
+    
+public:
+    
+    // The scheduling loop. Events go to `sink`; with NullSink the logging
+    // branches, and the lookups that only feed the log, compile away. With
+    // `until` it stops when simulated time reaches it and can be resumed.
+    template <class Sink>
+    void simulate(Sink& sink, int until = INT_MAX) {
+        logging = Sink::enabled;
+        
+        while (current_time < until && (completed < admitted || has_pending_arrivals())) {
+            add_arrivals(sink);
+            wake_blocked(sink);
+            
+#ifdef MLFQ_DEBUG
+            validate_queues();
+#endif
+            
+            if (current_time > 0 && current_time % config.aging_check_interval == 0) {
+                apply_aging(sink);
+            }
+            
+            if (current_time > 0 && current_time % config.boost_interval == 0) {
+                apply_priority_boost(sink);
+            }
+            
+            // Check for preemption
+            if (currently_running != nullptr && currently_running->remaining > 0) {
+                int running_queue = currently_running->priority;
+                
+                if (should_preempt(running_queue)) {
+                    if (Sink::enabled) {
+                        SchedEvent e = make_event(EVENT_PREEMPTION, current_time, 
+                                                  currently_running->pid, running_queue);
+                        set_next(e);
+                        sink.emit(e);
+                    }
+                    currently_running->enqueue_time = current_time;
+                    enqueue(currently_running, true);
+                    currently_running = nullptr;
+                    context_switches++;
+                }
+            }
+            
+            // Get next process if none running
+            if (currently_running == nullptr || currently_running->remaining == 0) {
+                int active_queue = get_highest_priority_queue();
+                
+                if (active_queue == -1) {
+                    // CPU idle: jump straight to the next arrival or I/O
+                    // completion (or boost boundary, so logged runs still
+                    // show every boost)
+                    int next_time = min(next_arrival_time(), next_wake_time());
+                    
+                    if (next_time != INT_MAX) {
+                        next_time = min(next_time, min(next_boost_time(), until));
+                        if (Sink::enabled) {
+                            SchedEvent e = make_event(EVENT_IDLE, current_time, 0, -1);
+                            e.arg = next_time;
+                            if (!blocked.empty()) e.flags = EVENT_BLOCKED;
+                            sink.emit(e);
+                        }
+                        record_timeline(0, -1, next_time - current_time);
+                        current_time = next_time;
+                    } else {
+                        break;
+                    }
+                    continue;
+                }
+                
+                currently_running = dequeue_next(active_queue);
+                currently_running->time_in_queue = waiting_time(currently_running);
+                
+                SchedEvent dispatch = make_event(EVENT_DISPATCH, current_time, 
+                                                 currently_running->pid, active_queue);
+                if (!currently_running->started) {
+                    currently_running->started = true;
+                    currently_running->start_time = current_time;
+                    dispatch.flags = EVENT_FIRST;
+                }
+                context_switches++;
+                if (Sink::enabled) {
+                    sink.emit(dispatch);
+                }
+            }
+            
+            // Execute until the next scheduling event; nothing changes in between
+            int slice = min(time_to_next_event(), until - current_time);
+            record_timeline(currently_running->pid, currently_running->priority, slice);
+            
+            currently_running->remaining -= slice;
+            currently_running->time_in_current_quantum += slice;
+            total_busy_time += slice;
+            
+            // Handle the end of the slice as the last executed time unit
+            current_time += slice - 1;
+            
+            // End of a CPU burst with I/O next
+            if (currently_running->remaining == 0 && 
+                currently_running->phase < currently_running->bursts.size()) {
+                block_running(sink);
+            }
+            // Check for completion
+            else if (currently_running->remaining == 0) {
+                currently_running->completion = current_time + 1;
+                retire(currently_running);
+                
+                if (Sink::enabled) {
+                    SchedEvent e = make_event(EVENT_COMPLETION, current_time + 1, 
+                                              currently_running->pid, currently_running->priority);
+                    set_next(e);
+                    if (e.other_pid == 0) {
+                        if (!has_pending_arrivals() && blocked.empty()) e.flags = EVENT_ALL_DONE;
+                        else if (blocked.empty() ? has_arrival_after(current_time + 1) 
+                                 : min(next_arrival_time(), next_wake_time()) > current_time + 1) {
+                            e.flags = EVENT_IDLE_NEXT;
+                        }
+                    }
+                    sink.emit(e);
+                }
+                currently_running = nullptr;
+            }
+            // Check if quantum exhausted (demotion)
+            else if (config.time_quantum[currently_running->priority] > 0 && 
+                     currently_running->time_in_current_quantum >= config.time_quantum[currently_running->priority]) {
+                
+                int old_queue = currently_running->priority;
+                
+                // Demote to lower priority queue (MLFQ feedback); the
+                // lowest queue keeps it
+                if (currently_running->priority < config.num_queues - 1) {
+                    currently_running->priority++;
+                }
+                
+                if (Sink::enabled) {
+                    SchedEvent e = make_event(EVENT_DEMOTION, current_time + 1, 
+                                              currently_running->pid, old_queue);
+                    e.to_queue = currently_running->priority;
+                    set_next(e);
+                    sink.emit(e);
+                }
+                
+                currently_running->time_in_current_quantum = 0;
+                currently_running->time_in_queue = 0;
+                currently_running->enqueue_time = current_time + 1;
+                enqueue(currently_running);
+                currently_running = nullptr;
+                context_switches++;
+            }
+            
+            current_time++;
+        }
+        
+        sink.flush();
+    }
+    
+    // Name the process the scheduler would dispatch now as the event's next
+    void set_next(SchedEvent& e) {
+        int q = get_highest_priority_queue();
+        if (q != -1) {
+            e.other_pid = next_in_queue(q)->pid;
+            e.other_queue = q;
+        }
+    }
+    
+    Metrics get_metrics() const {
+        Metrics m = totals.finish(total_busy_time, context_switches);
+        m.level_cpu.assign(queue_usage.begin(), queue_usage.end());
+        return m;
+    }
+    
+    const LatencyReport& get_latency() const {
+        return latency;
+    }
+    
+    const MetricsAccumulator& get_totals() const { return totals; }
+    int get_busy_time() const { return total_busy_time; }
+    int get_context_switches() const { return context_switches; }
+    const vector<int>& get_queue_usage() const { return queue_usage; }
+    
+    // Processes on this CPU that are assigned, queued or running; blocked
+    // ones are not counted
+    int load() const {
+        return admitted - completed - (int)blocked.size() + (int)pending.size();
+    }
+    
+    // Whether every process given to this CPU has completed
+    bool finished() const {
+        return completed == admitted && pending.empty();
+    }
+    
+    // Admit p at its arrival time, which must not be before that of any
+    // process assigned earlier
+    void assign(Process* p) {
+        pending.push_back(p);
+    }
+    
+    // Simulate up to time `until`; an idle CPU just moves its clock there
+    void advance(int until) {
+        NullSink sink;
+        simulate(sink, until);
+        current_time = max(current_time, until);
+    }
+    
+    // Move the process this CPU would dispatch next out of its queues into
+    // `into`, a slot of the stealing CPU, keeping its level, quantum use
+    // and aging progress. False if no process is waiting.
+    bool steal(Process* into) {
+        int q = get_highest_priority_queue();
+        if (q == -1) return false;
+        Process* p = dequeue_next(q);
+        p->time_in_queue = waiting_time(p);
+        *into = *p;
+        free_processes.push_back(p);
+        admitted--;
+        return true;
+    }
+    
+    // Queue a process taken from another CPU with steal()
+    void adopt(Process* p) {
+        p->enqueue_time = current_time;
+        enqueue(p);
+        admitted++;
+    }
+    
+    // Slot of a process that completed or was stolen here, or nullptr
+    Process* reuse_slot() {
+        if (free_processes.empty()) return nullptr;
+        Process* p = free_processes.back();
+        free_processes.pop_back();
+        return p;
+    }
+    
+    void print_results() {
+        cout << "\n========================================\n";
+        cout << "MLFQ SCHEDULER RESULTS\n";
+        cout << "========================================\n\n";
+        
+        Metrics m = get_metrics();
+        m.display_levels(config);
+        
+        if (trace == nullptr) {
+            cout << "Process-wise Metrics:\n";
+            cout << "PID\tArrival\tBurst\tInitPrio\tStart\tCompletion\tTAT\tWT\n";
+            cout << "---\t-------\t-----\t--------\t-----\t----------\t---\t--\n";
+            
+            for (auto& p : all_processes) {
+                int tat = p.completion - p.arrival;
+                int wt = tat - p.burst - p.io_time;
+                
+                cout << p.pid << "\t" << p.arrival << "\t" << p.burst << "\t"
+                     << p.initial_priority << "\t\t" << p.start_time << "\t" 
+                     << p.completion << "\t\t" << tat << "\t" << wt << "\n";
+            }
+        }
+        
+        cout << "\n========================================\n";
+        cout << "Overall Performance Metrics\n";
+        cout << "========================================\n";
+        m.display("MLFQ");
+        cout << "\n";
+        latency.print(cout);
+        
+        print_gantt_chart();
+        save_to_file();
+    }
+    
+    void print_gantt_chart() {
+        if (timeline.empty()) return;
+        
+        cout << "\n========================================\n";
+        cout << "Gantt Chart\n";
+        cout << "========================================\n";
+        
+        for (auto& seg : timeline) {
+            if (seg.pid == 0) {
+                cout << "[Idle] " << seg.start << "->" << seg.start + seg.length << "\n";
+            } else {
+                cout << "P" << seg.pid << " [Q" << seg.queue << "] " 
+                     << seg.start << "->" << seg.start + seg.length << "\n";
+            }
+        }
+        
+        const TimelineSegment& last = timeline.back();
+        int total = last.start + last.length;
+        int limit = min(100, total);
+        
+        // Expand the first `limit` units from the segments
+        vector<int> unit_pid, unit_queue;
+        for (size_t i = 0; i < timeline.size() && (int)unit_pid.size() < limit; i++) {
+            int n = min(timeline[i].length, limit - (int)unit_pid.size());
+            unit_pid.insert(unit_pid.end(), n, timeline[i].pid);
+            unit_queue.insert(unit_queue.end(), n, timeline[i].queue);
+        }
+        
+        cout << "\nDetailed Timeline (first " << limit << " units):\n";
+        cout << "Time: ";
+        for (int i = 0; i < limit; i++) {
+            cout << setw(3) << i;
+        }
+        if (total > limit) cout << " ...";
+        
+        cout << "\nProc: ";
+        for (int i = 0; i < limit; i++) {
+            if (unit_pid[i] == 0) cout << "  -";
+            else cout << " P" << unit_pid[i];
+        }
+        if (total > limit) cout << " ...";
+        
+        cout << "\nQueue:";
+        for (int i = 0; i < limit; i++) {
+            if (unit_queue[i] == -1) cout << "  -";
+            else cout << " Q" << unit_queue[i];
+        }
+        if (total > limit) cout << " ...";
+        cout << "\n";
+    }
+    
+    void save_to_file() {
+        ofstream fout("mlfq_results.txt");
+        Metrics m = get_metrics();
+        
+        fout << "MLFQ Scheduler Results\n";
+        fout << "======================\n\n";
+        
+        fout << "Configuration:\n";
+        fout << "Number of Queues: " << config.num_queues << "\n";
+        for (int i = 0; i < config.num_queues; i++) {
+            fout << "Q" << i << ": " << config.algo_names[i];
+            if (config.time_quantum[i] > 0) {
+                fout << " (TQ=" << config.time_quantum[i] << ")";
+            }
+            fout << "\n";
+        }
+        fout << "\n";
+        
+        fout << "Performance Metrics:\n";
+        fout << "Average Turnaround Time: " << m.avg_turnaround << "\n";
+        fout << "Average Waiting Time: " << m.avg_waiting << "\n";
         fout << "Throughput: " << m.throughput << "\n";
         fout << "CPU Utilization: " << m.cpu_util << "%\n";
         fout << "Context Switches: " << m.context_switches << "\n";
+        fout << "\n";
+        
+        fout << "Queue Usage:\n";
+        for (int q = 0; q < config.num_queues; q++) {
+            fout << "Q" << q << ": " << queue_usage[q] << " time units\n";
+        }
+        fout << "\n";
+        
+        latency.print(fout);
+        
+        if (keep_timeline) {
+            fout << "Gantt Chart:\n";
+            for (auto& seg : timeline) {
+                if (seg.pid == 0) {
+                    fout << "Idle\t" << seg.start << "\t" << seg.start + seg.length << "\n";
+                } else {
+                    fout << "P" << seg.pid << "\tQ" << seg.queue << "\t" 
+                         << seg.start << "\t" << seg.start + seg.length << "\n";
+                }
+            }
+        }
+        
+        fout.close();
+        
+        if (verbose_mode) {
+            cout << "\nResults saved to: mlfq_results.txt\n";
+        }
+    }
+};
+
+// ==================== SMP SCHEDULER ====================
+// Runs step(w) for w = 0..n-1 on n threads, once per call to run(): the
+// calling thread takes part 0 and run() returns when every part is done.
+// Between calls the workers spin, then yield, instead of sleeping: a
+// simulation epoch is often only microseconds of work.
+class LockstepWorkers {
+private:
+    function<void(int)> step;
+    vector<thread> threads;
+    atomic<long long> generation;   // Bumped to start a round
+    atomic<int> running;            // Workers still in the current round
+    atomic<bool> stopping;
+    
+    template <class Ready>
+    static void wait_for(Ready ready) {
+        for (int spins = 0; !ready(); spins++) {
+            if (spins >= 1000) this_thread::yield();
+        }
+    }
+    
+    void worker(int w) {
+        for (long long seen = 1; ; seen++) {
+            wait_for([this, seen] { return generation.load(memory_order_acquire) >= seen; });
+            if (stopping.load(memory_order_relaxed)) return;
+            step(w);
+            running.fetch_sub(1, memory_order_acq_rel);
+        }
+    }
+    
+public:
+    LockstepWorkers(int n, function<void(int)> f) 
+        : step(f), generation(0), running(0), stopping(false) {
+        for (int w = 1; w < n; w++) {
+            threads.emplace_back(&LockstepWorkers::worker, this, w);
+        }
+    }
+    
+    ~LockstepWorkers() {
+        stopping.store(true, memory_order_relaxed);
+        generation.fetch_add(1, memory_order_release);
+        for (auto& t : threads) t.join();
+    }
+    
+    void run() {
+        running.store(threads.size(), memory_order_relaxed);
+        generation.fetch_add(1, memory_order_release);
+        step(0);
+        wait_for([this] { return running.load(memory_order_acquire) == 0; });
+    }
+};
+
+// MLFQ on several CPUs sharing one clock. Each CPU is an MLFQ_Scheduler
+// with its own level queues, aging and boosts; they only interact at
+// balance points, every aging check interval unless set otherwise. There
+// the least loaded CPU steals the next process of the busiest one until
+// no CPU has two processes more than another, and the processes arriving
+// before the next balance point are assigned, each to the least loaded
+// CPU (lowest index on ties). One CPU gives exactly the single-CPU MLFQ
+// results.
+//
+// Between balance points the CPUs are independent, so with several
+// threads each one advances a fixed block of CPUs through the epoch and
+// they meet at the next balance point. The results do not depend on the
+// number of threads.
+class SMP_Scheduler : public Scheduler {
+private:
+    ProcessSource& source;
+    Config config;
+    vector<unique_ptr<MLFQ_Scheduler>> cpus;
+    deque<Process> process_pool;        // Storage for processes; each CPU recycles its own
+    vector<long long> migrations;       // Processes each CPU stole
+    long long processes_seen;
+    int current_time;
+    int balance_interval;
+    int num_threads;
+    
+    // A free process slot for CPU c
+    Process* slot_for(int c) {
+        Process* p = cpus[c]->reuse_slot();
+        if (p == nullptr) {
+            process_pool.emplace_back();
+            p = &process_pool.back();
+        }
+        return p;
+    }
+    
+    void steal_work() {
+        while (true) {
+            size_t thief = 0, victim = 0;
+            for (size_t c = 1; c < cpus.size(); c++) {
+                if (cpus[c]->load() < cpus[thief]->load()) thief = c;
+                if (cpus[c]->load() > cpus[victim]->load()) victim = c;
+            }
+            // A CPU with two processes more than another has one waiting, as
+            // nothing is pending at a balance point; stop if it has not
+            if (cpus[victim]->load() - cpus[thief]->load() < 2) return;
+            Process* p = slot_for(thief);
+            if (!cpus[victim]->steal(p)) return;
+            cpus[thief]->adopt(p);
+            migrations[thief]++;
+        }
+    }
+    
+    void assign_arrivals(int until) {
+        if (source.empty() || source.peek().arrival >= until) return;
+        
+        priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> least_loaded;
+        for (size_t c = 0; c < cpus.size(); c++) {
+            least_loaded.push(make_pair(cpus[c]->load(), (int)c));
+        }
+        while (!source.empty() && source.peek().arrival < until) {
+            pair<int, int> cpu = least_loaded.top();
+            least_loaded.pop();
+            ProcessOriginal o = source.next();
+            Process* p = slot_for(cpu.second);
+            *p = Process(o.pid, o.arrival, o.burst, o.initial_priority, o.bursts);
+            cpus[cpu.second]->assign(p);
+            processes_seen++;
+            least_loaded.push(make_pair(cpu.first + 1, cpu.second));
+        }
+    }
+    
+public:
+    SMP_Scheduler(ProcessSource& src, const Config& cfg, int num_cpus) 
+        : source(src), config(cfg), migrations(num_cpus, 0), processes_seen(0), current_time(0),
+          balance_interval(cfg.aging_check_interval), num_threads(1) {
+        for (int c = 0; c < num_cpus; c++) {
+            cpus.emplace_back(new MLFQ_Scheduler(config));
+        }
+    }
+    
+    // Time between balance points. Longer epochs mean fewer barriers
+    // between threads but coarser placement and stealing.
+    void set_balance_interval(int interval) {
+        balance_interval = interval;
+    }
+    
+    // Threads to advance the CPUs on (0: one per core), at most one per CPU
+    void set_threads(int threads) {
+        if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+        num_threads = min<int>(threads, cpus.size());
+    }
+    
+    string name() const override { return "MLFQ-SMP"; }
+    
+    Metrics run() override {
+        int interval = balance_interval;
+        int epoch_end = 0;
+        
+        // Worker w advances CPUs [w * K / n, (w + 1) * K / n)
+        auto advance_part = [this, &epoch_end](int w) {
+            size_t first = w * cpus.size() / num_threads;
+            size_t last = (w + 1) * cpus.size() / num_threads;
+            for (size_t c = first; c < last; c++) {
+                cpus[c]->advance(epoch_end);
+            }
+        };
+        unique_ptr<LockstepWorkers> workers;
+        if (num_threads > 1) {
+            workers.reset(new LockstepWorkers(num_threads, advance_part));
+        }
+        auto advance_all = [&](int until) {
+            epoch_end = until;
+            if (workers) workers->run();
+            else advance_part(0);
+        };
+        
+        while (true) {
+            bool busy = false;
+            for (auto& cpu : cpus) {
+                busy = busy || !cpu->finished();
+            }
+            if (!busy) {
+                if (source.empty()) break;
+                // Every CPU idle: skip to the balance point before the next arrival
+                int next = source.peek().arrival / interval * interval;
+                if (next > current_time) {
+                    current_time = next;
+                    advance_all(current_time);
+                }
+            }
+            
+            steal_work();
+            assign_arrivals(current_time + interval);
+            current_time += interval;
+            advance_all(current_time);
+        }
+        return get_metrics();
+    }
+    
+    Metrics get_metrics() const {
+        MetricsAccumulator totals;
+        long long busy = 0;
+        int switches = 0;
+        for (auto& cpu : cpus) {
+            totals.merge(cpu->get_totals());
+            busy += cpu->get_busy_time();
+            switches += cpu->get_context_switches();
+        }
+        Metrics m = totals.finish(busy, switches);
+        m.cpu_util /= cpus.size();
+        m.level_cpu.assign(config.num_queues, 0);
+        for (auto& cpu : cpus) {
+            for (int q = 0; q < config.num_queues; q++) {
+                m.level_cpu[q] += cpu->get_queue_usage()[q];
+            }
+        }
+        for (size_t c = 0; c < cpus.size(); c++) {
+            m.cpu_utilization.push_back(100.0 * cpus[c]->get_busy_time() / max(1, totals.last_completion));
+            m.cpu_migrations.push_back(migrations[c]);
+        }
+        return m;
+    }
+    
+    LatencyReport get_latency() const {
+        LatencyReport report;
+        report.reset(config.num_queues);
+        for (auto& cpu : cpus) {
+            report.merge(cpu->get_latency());
+        }
+        return report;
+    }
+    
+    long long processes_simulated() const { return processes_seen; }
+    int num_cpus() const { return cpus.size(); }
+    int threads() const { return num_threads; }
+};
+
+// ==================== COMPARISON SCHEDULERS ====================
+// Each works on its own copy of the processes, sorted by arrival
+class BaselineScheduler : public Scheduler {
+protected:
+    vector<Process> processes;
+    
+    BaselineScheduler(const vector<Process>& procs) : processes(procs) {
+        sort(processes.begin(), processes.end(), 
+             [](const Process& a, const Process& b) { return a.arrival < b.arrival; });
+    }
+    
+    // Metrics once every process has completed
+    Metrics summarize(int total_busy_time, int context_switches) const {
+        MetricsAccumulator totals;
+        for (auto& p : processes) {
+            totals.add(p);
+        }
+        return totals.finish(total_busy_time, context_switches);
+    }
+};
+
+class RR_Scheduler : public BaselineScheduler {
+private:
+    int time_quantum;
+    
+public:
+    RR_Scheduler(const vector<Process>& procs, int tq) : BaselineScheduler(procs), time_quantum(tq) {}
+    
+    string name() const override { return "RR"; }
+    string full_name() const override { return "Round Robin"; }
+    
+    Metrics run() override {
+        deque<Process*> ready_queue;
+        int current_time = 0;
+        size_t completed = 0;
+        int total_busy_time = 0;
+        int context_switches = 0;
+        size_t next_arrival = 0;
+        
+        // A quantum below 1 behaves like 1: preempt after every time unit
+        int quantum = max(1, time_quantum);
+        
+        while (completed < processes.size()) {
+            while (next_arrival < processes.size() && processes[next_arrival].arrival <= current_time) {
+                ready_queue.push_back(&processes[next_arrival]);
+                next_arrival++;
+            }
+            
+            if (ready_queue.empty()) {
+                // CPU idle: jump to the next arrival
+                current_time = processes[next_arrival].arrival;
+                continue;
+            }
+            
+            Process* p = ready_queue.front();
+            ready_queue.pop_front();
+            if (!p->started) {
+                p->started = true;
+                p->start_time = current_time;
+            }
+            context_switches++;
+            
+            // Arrivals never preempt in RR, so the whole quantum runs in one step
+            int slice = min(quantum, p->remaining);
+            p->remaining -= slice;
+            current_time += slice;
+            total_busy_time += slice;
+            
+            if (p->remaining == 0) {
+                p->completion = current_time;
+                completed++;
+            } else {
+                // Processes that arrived during the slice queue ahead of it
+                while (next_arrival < processes.size() && processes[next_arrival].arrival < current_time) {
+                    ready_queue.push_back(&processes[next_arrival]);
+                    next_arrival++;
+                }
+                ready_queue.push_back(p);
+            }
+        }
+        
+        return summarize(total_busy_time, context_switches);
+    }
+};
+
+class FCFS_Scheduler : public BaselineScheduler {
+public:
+    FCFS_Scheduler(const vector<Process>& procs) : BaselineScheduler(procs) {}
+    
+    string name() const override { return "FCFS"; }
+    
+    Metrics run() override {
+        int current_time = 0;
+        int total_busy_time = 0;
+        int context_switches = 0;
+        
+        for (auto& p : processes) {
+            if (current_time < p.arrival) {
+                current_time = p.arrival;
+            }
+            
+            p.start_time = current_time;
+            p.started = true;
+            current_time += p.burst;
+            p.completion = current_time;
+            total_busy_time += p.burst;
+            context_switches++;
+        }
         
-        fout.close();
+        return summarize(total_busy_time, context_switches);
+    }
+};
+
+class SJF_Scheduler : public BaselineScheduler {
+public:
+    SJF_Scheduler(const vector<Process>& procs) : BaselineScheduler(procs) {}
+    
+    string name() const override { return "SJF"; }
+    
+    Metrics run() override {
+        int current_time = 0;
+        size_t completed = 0;
+        int total_busy_time = 0;
+        int context_switches = 0;
+        size_t next_arrival = 0;
         
-        if (verbose_mode) {
-            cout << "\nResults saved to: mlfq_results.txt\n";
+        // Arrived processes keyed by (burst, index): ties go to the earlier arrival
+        priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> ready;
+        
+        while (completed < processes.size()) {
+            while (next_arrival < processes.size() && processes[next_arrival].arrival <= current_time) {
+                ready.push(make_pair(processes[next_arrival].burst, (int)next_arrival));
+                next_arrival++;
+            }
+            
+            if (ready.empty()) {
+                current_time = processes[next_arrival].arrival;
+                continue;
+            }
+            
+            Process& p = processes[ready.top().second];
+            ready.pop();
+            p.start_time = current_time;
+            p.started = true;
+            current_time += p.burst;
+            p.completion = current_time;
+            total_busy_time += p.burst;
+            completed++;
+            context_switches++;
+        }
+        
+        return summarize(total_busy_time, context_switches);
+    }
+};
+
+// Preemptive SJF: an arrival with less remaining work than the running
+// process takes the CPU. Gives the lowest possible average waiting time.
+class SRTF_Scheduler : public BaselineScheduler {
+public:
+    SRTF_Scheduler(const vector<Process>& procs) : BaselineScheduler(procs) {}
+    
+    string name() const override { return "SRTF"; }
+    
+    Metrics run() override {
+        int current_time = 0;
+        size_t completed = 0;
+        int total_busy_time = 0;
+        int context_switches = 0;
+        size_t next_arrival = 0;
+        int running = -1;
+        
+        // Waiting processes keyed by (remaining, index): ties go to the earlier arrival
+        priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> ready;
+        
+        while (completed < processes.size()) {
+            while (next_arrival < processes.size() && processes[next_arrival].arrival <= current_time) {
+                ready.push(make_pair(processes[next_arrival].remaining, (int)next_arrival));
+                next_arrival++;
+            }
+            
+            // Preempt only for strictly less remaining work
+            if (running != -1 && !ready.empty() && 
+                ready.top().first < processes[running].remaining) {
+                ready.push(make_pair(processes[running].remaining, running));
+                running = -1;
+            }
+            
+            if (running == -1) {
+                if (ready.empty()) {
+                    current_time = processes[next_arrival].arrival;
+                    continue;
+                }
+                running = ready.top().second;
+                ready.pop();
+                
+                Process& p = processes[running];
+                if (!p.started) {
+                    p.started = true;
+                    p.start_time = current_time;
+                }
+                context_switches++;
+            }
+            
+            // Run until completion or the next arrival, whichever is first
+            Process& p = processes[running];
+            int slice = p.remaining;
+            if (next_arrival < processes.size()) {
+                slice = min(slice, processes[next_arrival].arrival - current_time);
+            }
+            p.remaining -= slice;
+            current_time += slice;
+            total_busy_time += slice;
+            
+            if (p.remaining == 0) {
+                p.completion = current_time;
+                completed++;
+                running = -1;
+            }
+        }
+        
+        return summarize(total_busy_time, context_switches);
+    }
+};
+
+// ==================== PARALLEL EXECUTION ====================
+// Run independent jobs on a pool of worker threads (one per core, at most
+// one per job). Jobs are handed out in order; each must only write its own
+// results.
+void run_parallel(const vector<function<void()>>& jobs, unsigned max_threads = 0) {
+    unsigned workers = max_threads ? max_threads : max(1u, thread::hardware_concurrency());
+    workers = min<size_t>(workers, jobs.size());
+    
+    atomic<size_t> next_job(0);
+    auto worker = [&]() {
+        for (size_t i = next_job++; i < jobs.size(); i = next_job++) {
+            jobs[i]();
+        }
+    };
+    
+    vector<thread> threads;
+    for (unsigned i = 1; i < workers; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : threads) t.join();
+}
+
+// Fresh simulation state for every scheduler run
+vector<Process> make_processes(const vector<ProcessOriginal>& original_data) {
+    vector<Process> procs;
+    procs.reserve(original_data.size());
+    for (auto& o : original_data) {
+        procs.emplace_back(o.pid, o.arrival, o.burst, o.initial_priority, o.bursts);
+    }
+    return procs;
+}
+
+bool any_io(const vector<ProcessOriginal>& original_data) {
+    for (auto& o : original_data) {
+        if (!o.bursts.empty()) return true;
+    }
+    return false;
+}
+
+// ==================== COMPARATIVE ANALYSIS ====================
+void run_comparative_analysis(const vector<ProcessOriginal>& original_data, const Config& config) {
+    cout << "\n========================================\n";
+    cout << "COMPARATIVE ANALYSIS\n";
+    cout << "========================================\n\n";
+    // The other schedulers model CPU-only processes
+    if (any_io(original_data)) {
+        cout << "Skipped: the workload has I/O bursts, which only MLFQ models.\n";
+        return;
+    }
+    cout << "Comparing MLFQ with other scheduling algorithms...\n\n";
+    
+    // Each scheduler works on its own copy of the processes, so they run
+    // concurrently; results are stored by position, keeping output order
+    vector<Process> procs = make_processes(original_data);
+    vector<unique_ptr<Scheduler>> schedulers;
+    schedulers.emplace_back(new MLFQ_Scheduler(procs, config));
+    schedulers.emplace_back(new RR_Scheduler(procs, 4));
+    schedulers.emplace_back(new FCFS_Scheduler(procs));
+    schedulers.emplace_back(new SJF_Scheduler(procs));
+    schedulers.emplace_back(new SRTF_Scheduler(procs));
+    
+    vector<Metrics> metrics(schedulers.size());
+    vector<function<void()>> jobs;
+    for (size_t i = 0; i < schedulers.size(); i++) {
+        jobs.push_back([&, i]() { metrics[i] = schedulers[i]->run(); });
+    }
+    run_parallel(jobs);
+    
+    // Display comparison table
+    cout << "\n========================================\n";
+    cout << "PERFORMANCE COMPARISON TABLE\n";
+    cout << "========================================\n\n";
+    
+    cout << left << setw(15) << "Algorithm" 
+         << right << setw(12) << "Avg TAT" 
+         << setw(12) << "Avg WT" 
+         << setw(12) << "Throughput"
+         << setw(12) << "CPU Util%"
+         << setw(12) << "Ctx Switch" << "\n";
+    cout << string(73, '-') << "\n";
+    
+    for (size_t i = 0; i < schedulers.size(); i++) {
+        cout << left << setw(15) << schedulers[i]->full_name()
+             << right << setw(12) << fixed << setprecision(2) << metrics[i].avg_turnaround
+             << setw(12) << metrics[i].avg_waiting
+             << setw(12) << setprecision(3) << metrics[i].throughput
+             << setw(12) << setprecision(2) << metrics[i].cpu_util
+             << setw(12) << metrics[i].context_switches << "\n";
+    }
+    
+    cout << "\n========================================\n";
+    cout << "ANALYSIS\n";
+    cout << "========================================\n";
+    
+    size_t best_tat = 0, best_wt = 0;
+    for (size_t i = 1; i < schedulers.size(); i++) {
+        if (metrics[i].avg_turnaround < metrics[best_tat].avg_turnaround) best_tat = i;
+        if (metrics[i].avg_waiting < metrics[best_wt].avg_waiting) best_wt = i;
+    }
+    
+    cout << "\nBest Average Turnaround Time: " << schedulers[best_tat]->name() 
+         << " (" << metrics[best_tat].avg_turnaround << ")\n";
+    cout << "Best Average Waiting Time: " << schedulers[best_wt]->name() 
+         << " (" << metrics[best_wt].avg_waiting << ")\n";
+    
+    // Save comparison
+    ofstream fout("comparison_results.txt");
+    fout << "Scheduling Algorithm Comparison\n";
+    fout << "================================\n\n";
+    fout << "Algorithm\tAvg TAT\tAvg WT\tThroughput\tCPU Util%\tContext Switches\n";
+    for (size_t i = 0; i < schedulers.size(); i++) {
+        fout << schedulers[i]->name() << "\t" << metrics[i].avg_turnaround << "\t" 
+             << metrics[i].avg_waiting << "\t" << metrics[i].throughput << "\t" 
+             << metrics[i].cpu_util << "\t" << metrics[i].context_switches << "\n";
+    }
+    fout.close();
+    
+    cout << "\nComparison results saved to: comparison_results.txt\n";
+}
+
+// ==================== PARAMETER SWEEP ====================
+// Sweep specification file, laid out like config.txt but with a value or
+// an inclusive range "first:last[:step]" in place of each number:
+//   <Number of Queues>
+//   <Time Quantum Q0> <Time Quantum Q1> ...
+//   <Aging Threshold> <Aging Check Interval> <Boost Interval>
+struct SweepSpec {
+    int num_queues;
+    vector<vector<int>> time_quantum;
+    vector<int> aging_threshold;
+    vector<int> aging_check_interval;
+    vector<int> boost_interval;
+    
+    static bool parse_range(const string& token, vector<int>& values) {
+        int first, last, step = 1;
+        char sep1 = 0, sep2 = 0;
+        istringstream in(token);
+        in >> first;
+        if (!in) return false;
+        last = first;
+        if (in >> sep1) {
+            if (sep1 != ':' || !(in >> last)) return false;
+            if (in >> sep2 && (sep2 != ':' || !(in >> step) || step < 1)) return false;
+        }
+        if (last < first) return false;
+        values.clear();
+        for (long long v = first; v <= last; v += step) {
+            values.push_back((int)v);
+        }
+        return true;
+    }
+    
+    bool load_from_file(const string& filename, string& error) {
+        ifstream fin(filename);
+        if (!fin) {
+            error = "cannot open file";
+            return false;
+        }
+        
+        string token;
+        if (!(fin >> num_queues) || num_queues < 1) {
+            error = "expected the number of queues";
+            return false;
+        }
+        time_quantum.resize(num_queues);
+        for (int i = 0; i < num_queues; i++) {
+            if (!(fin >> token) || !parse_range(token, time_quantum[i])) {
+                error = "bad time quantum for Q" + to_string(i) + ": " + token;
+                return false;
+            }
+        }
+        
+        vector<int>* fields[3] = {&aging_threshold, &aging_check_interval, &boost_interval};
+        const char* names[3] = {"aging threshold", "aging check interval", "boost interval"};
+        for (int i = 0; i < 3; i++) {
+            if (!(fin >> token) || !parse_range(token, *fields[i])) {
+                error = string("bad ") + names[i] + ": " + token;
+                return false;
+            }
+        }
+        if (aging_check_interval.front() < 1 || boost_interval.front() < 1) {
+            error = "intervals must be at least 1";
+            return false;
+        }
+        return true;
+    }
+    
+    // Cartesian product of all ranges
+    vector<Config> expand() const {
+        vector<Config> configs;
+        Config base;
+        base.num_queues = num_queues;
+        base.time_quantum.assign(num_queues, 0);
+        base.algo_names.assign(num_queues, "");
+        
+        function<void(int)> fill_quanta = [&](int q) {
+            if (q == num_queues) {
+                for (int at : aging_threshold) {
+                    for (int aci : aging_check_interval) {
+                        for (int bi : boost_interval) {
+                            Config c = base;
+                            for (int i = 0; i < num_queues; i++) {
+                                c.algo_names[i] = c.time_quantum[i] > 0 ? "Round-Robin" : "FCFS";
+                            }
+                            c.aging_threshold = at;
+                            c.aging_check_interval = aci;
+                            c.boost_interval = bi;
+                            configs.push_back(c);
+                        }
+                    }
+                }
+                return;
+            }
+            for (int tq : time_quantum[q]) {
+                base.time_quantum[q] = tq;
+                fill_quanta(q + 1);
+            }
+        };
+        fill_quanta(0);
+        return configs;
+    }
+};
+
+struct SweepResult {
+    Config config;
+    Metrics metrics;
+};
+
+string describe_quanta(const Config& c) {
+    string s;
+    for (int i = 0; i < c.num_queues; i++) {
+        if (i > 0) s += "/";
+        s += to_string(c.time_quantum[i]);
+    }
+    return s;
+}
+
+// Run MLFQ once per configuration in the sweep, all cores sharing the one
+// read-only workload, and rank configurations by average waiting time
+// (then turnaround time, then context switches)
+int run_sweep(const vector<ProcessOriginal>& original_data, const string& spec_file) {
+    SweepSpec spec;
+    string error;
+    if (!spec.load_from_file(spec_file, error)) {
+        cerr << "Error: " << spec_file << ": " << error << "\n";
+        return 1;
+    }
+    
+    // Same admission order as the main simulation
+    vector<Process> workload = make_processes(original_data);
+    sort(workload.begin(), workload.end(), 
+         [](const Process& a, const Process& b) {
+             return a.arrival < b.arrival || (a.arrival == b.arrival && a.pid < b.pid);
+         });
+    
+    vector<Config> configs = spec.expand();
+    vector<SweepResult> results(configs.size());
+    cout << "\nSweeping " << configs.size() << " configurations over " 
+         << workload.size() << " processes...\n";
+    
+    vector<function<void()>> jobs;
+    for (size_t i = 0; i < configs.size(); i++) {
+        jobs.push_back([&, i]() {
+            MLFQ_Scheduler mlfq(workload, configs[i]);
+            mlfq.run(false);
+            results[i].config = configs[i];
+            results[i].metrics = mlfq.get_metrics();
+        });
+    }
+    run_parallel(jobs);
+    
+    stable_sort(results.begin(), results.end(), 
+                [](const SweepResult& a, const SweepResult& b) {
+                    if (a.metrics.avg_waiting != b.metrics.avg_waiting) 
+                        return a.metrics.avg_waiting < b.metrics.avg_waiting;
+                    if (a.metrics.avg_turnaround != b.metrics.avg_turnaround) 
+                        return a.metrics.avg_turnaround < b.metrics.avg_turnaround;
+                    return a.metrics.context_switches < b.metrics.context_switches;
+                });
+    
+    cout << "\n========================================\n";
+    cout << "PARAMETER SWEEP RANKING\n";
+    cout << "========================================\n\n";
+    
+    cout << left << setw(6) << "Rank" << setw(20) << "Quanta"
+         << right << setw(8) << "Aging" << setw(8) << "Check" << setw(8) << "Boost"
+         << setw(12) << "Avg TAT" << setw(12) << "Avg WT" << setw(12) << "Ctx Switch" << "\n";
+    cout << string(86, '-') << "\n";
+    
+    size_t shown = min<size_t>(20, results.size());
+    for (size_t i = 0; i < shown; i++) {
+        const SweepResult& r = results[i];
+        cout << left << setw(6) << (i + 1) << setw(20) << describe_quanta(r.config)
+             << right << setw(8) << r.config.aging_threshold 
+             << setw(8) << r.config.aging_check_interval 
+             << setw(8) << r.config.boost_interval
+             << setw(12) << fixed << setprecision(2) << r.metrics.avg_turnaround
+             << setw(12) << r.metrics.avg_waiting 
+             << setw(12) << r.metrics.context_switches << "\n";
+    }
+    if (shown < results.size()) {
+        cout << "... " << (results.size() - shown) << " more\n";
+    }
+    
+    ofstream fout("sweep_results.txt");
+    fout << "MLFQ Parameter Sweep\n";
+    fout << "====================\n\n";
+    fout << "Rank\tQuanta\tAging Threshold\tAging Check Interval\tBoost Interval\t"
+         << "Avg TAT\tAvg WT\tThroughput\tCPU Util%\tContext Switches\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const SweepResult& r = results[i];
+        fout << (i + 1) << "\t" << describe_quanta(r.config) << "\t" 
+             << r.config.aging_threshold << "\t" << r.config.aging_check_interval << "\t" 
+             << r.config.boost_interval << "\t" << r.metrics.avg_turnaround << "\t" 
+             << r.metrics.avg_waiting << "\t" << r.metrics.throughput << "\t" 
+             << r.metrics.cpu_util << "\t" << r.metrics.context_switches << "\n";
+    }
+    fout.close();
+    
+    cout << "\nFull ranking saved to: sweep_results.txt\n";
+    return 0;
+}
+
+// Complete an event log written by a run and report it
+bool finish_event_log(EventLogWriter& event_log, const string& event_file) {
+    if (!event_log.close()) {
+        cerr << "Error: Cannot write file: " << event_file << "\n";
+        return false;
+    }
+    cout << "\nEvents saved to: " << event_file << " (" << event_log.events_written() << " events)\n";
+    return true;
+}
+
+// ==================== SMP MODE ====================
+// Multi-CPU settings from the command line
+struct SMPOptions {
+    int num_cpus;           // --cpus; 0: the single-CPU scheduler
+    int threads;            // --threads; 0: one per core
+    int balance_interval;   // --balance; 0: the aging check interval
+    
+    SMPOptions() : num_cpus(0), threads(0), balance_interval(0) {}
+    
+    void apply(SMP_Scheduler& smp) const {
+        smp.set_threads(threads);
+        if (balance_interval > 0) smp.set_balance_interval(balance_interval);
+    }
+};
+
+void print_cpu_stats(ostream& out, const Metrics& m) {
+    out << "Per-CPU Statistics:\n";
+    out << left << setw(8) << "CPU" << right << setw(12) << "Util%" << setw(14) << "Migrations" << "\n";
+    for (size_t c = 0; c < m.cpu_utilization.size(); c++) {
+        out << left << setw(8) << c << right << setw(12) << fixed << setprecision(2) 
+            << m.cpu_utilization[c] << setw(14) << m.cpu_migrations[c] << "\n";
+    }
+    out << "\n";
+}
+
+// Print the results of a finished SMP run and save them to smp_results.txt
+void report_smp(const SMP_Scheduler& smp, const Config& config) {
+    Metrics m = smp.get_metrics();
+    LatencyReport latency = smp.get_latency();
+    
+    cout << "\n========================================\n";
+    cout << "MLFQ SMP RESULTS (" << smp.num_cpus() << " CPUs, " << smp.threads() << " threads)\n";
+    cout << "========================================\n";
+    config.display();
+    cout << "Processes simulated: " << smp.processes_simulated() << "\n";
+    m.display("MLFQ-SMP");
+    cout << "\n";
+    m.display_levels(config);
+    print_cpu_stats(cout, m);
+    latency.print(cout);
+    
+    ofstream fout("smp_results.txt");
+    fout << "MLFQ SMP Results\n";
+    fout << "================\n\n";
+    fout << "CPUs: " << smp.num_cpus() << "\n";
+    fout << "Processes: " << smp.processes_simulated() << "\n\n";
+    
+    fout << "Performance Metrics:\n";
+    fout << "Average Turnaround Time: " << m.avg_turnaround << "\n";
+    fout << "Average Waiting Time: " << m.avg_waiting << "\n";
+    fout << "Throughput: " << m.throughput << "\n";
+    fout << "CPU Utilization: " << m.cpu_util << "%\n";
+    fout << "Context Switches: " << m.context_switches << "\n";
+    fout << "\n";
+    
+    fout << "Queue Usage:\n";
+    for (int q = 0; q < config.num_queues; q++) {
+        fout << "Q" << q << ": " << m.level_cpu[q] << " time units\n";
+    }
+    fout << "\n";
+    
+    print_cpu_stats(fout, m);
+    latency.print(fout);
+    fout.close();
+    
+    cout << "Results saved to: smp_results.txt\n";
+}
+
+// ==================== STREAMING MODE ====================
+// Simulates a trace too large to hold in memory: processes are read as
+// simulated time reaches them, so the file must be sorted by arrival.
+// Only MLFQ runs, on several CPUs if smp_options asks for them; the
+// comparison schedulers need the whole workload.
+int run_streaming(const string& infile, const Config& config, const string& event_file,
+                  const SMPOptions& smp_options) {
+    TraceReader trace;
+    if (!trace.open(infile)) {
+        cerr << "Error: Cannot open file: " << infile << "\n";
+        return 1;
+    }
+    EventLogWriter event_log;
+    if (!event_file.empty() && !event_log.open(event_file)) {
+        cerr << "Error: Cannot write file: " << event_file << "\n";
+        return 1;
+    }
+    cout << "\nStreaming processes from: " << infile << "\n";
+    
+    unique_ptr<MLFQ_Scheduler> scheduler;
+    unique_ptr<SMP_Scheduler> smp;
+    if (smp_options.num_cpus > 0) {
+        smp.reset(new SMP_Scheduler(trace, config, smp_options.num_cpus));
+        smp_options.apply(*smp);
+        smp->run();
+    } else {
+        scheduler.reset(new MLFQ_Scheduler(trace, config));
+        if (!event_file.empty()) scheduler->set_event_log(&event_log);
+        scheduler->run(false);
+        if (!event_file.empty() && !finish_event_log(event_log, event_file)) {
+            return 1;
         }
     }
-};
+    
+    if (!trace.error().empty()) {
+        cerr << "Error: " << infile << ": " << trace.error() << "\n";
+        return 1;
+    }
+    if (trace.processes_read() == 0) {
+        cerr << "Error: No processes found!\n";
+        return 1;
+    }
+    
+    if (smp) {
+        report_smp(*smp, config);
+    } else {
+        cout << "Processes simulated: " << trace.processes_read() << "\n";
+        scheduler->get_metrics().display("MLFQ");
+        cout << "\n";
+        scheduler->get_latency().print(cout);
+        scheduler->save_to_file();
+        cout << "\nResults saved to: mlfq_results.txt\n";
+    }
+    
+    cout << "\n====================================================================\n";
+    cout << "                      Simulation Complete!                          \n";
+    cout << "====================================================================\n\n";
+    return 0;
+}
+
+// ==================== TRACE CONVERSION ====================
+int convert_trace(const string& infile, const string& outfile) {
+    vector<ProcessOriginal> procs;
+    string error;
+    if (!load_process_file(infile, procs, error)) {
+        cerr << "Error: " << infile << ": " << error << "\n";
+        return 1;
+    }
+    if (any_io(procs)) {
+        cerr << "Error: " << infile << ": binary traces hold CPU-only processes\n";
+        return 1;
+    }
+    if (!save_binary_trace(outfile, procs)) {
+        cerr << "Error: Cannot write file: " << outfile << "\n";
+        return 1;
+    }
+    cout << "\nConverted " << procs.size() << " processes: " << infile << " -> " << outfile << "\n";
+    return 0;
+}
+
+// ==================== EVENT LOG REPORT ====================
+bool load_event_log(const string& filename, vector<SchedEvent>& events, string& error) {
+    ifstream fin(filename, ios::binary);
+    if (!fin) {
+        error = "cannot open file";
+        return false;
+    }
+    vector<char> data;
+    if (!read_whole_file(fin, data)) {
+        error = "read error";
+        return false;
+    }
+    
+    EventLogHeader h;
+    if (data.size() >= sizeof(h)) memcpy(&h, data.data(), sizeof(h));
+    if (data.size() < sizeof(h) || memcmp(h.magic, EVENT_LOG_MAGIC, sizeof(EVENT_LOG_MAGIC)) != 0) {
+        error = "not an event log";
+        return false;
+    }
+    if (h.version != EVENT_LOG_VERSION || h.record_size != sizeof(SchedEvent)) {
+        error = "unsupported event log version " + to_string(h.version);
+        return false;
+    }
+    // Divided rather than multiplied so a corrupt count cannot wrap
+    uint64_t body = data.size() - sizeof(h);
+    if (body % sizeof(SchedEvent) != 0 || h.count != body / sizeof(SchedEvent)) {
+        error = "event log size does not match its header";
+        return false;
+    }
+    
+    events.resize(h.count);
+    memcpy(events.data(), data.data() + sizeof(h), body);
+    return true;
+}
 
-// ==================== COMPARISON SCHEDULERS ====================
+// One history entry, e.g. "12 demote Q0->Q1"
+string describe_event(const SchedEvent& e) {
+    string text = to_string(e.time) + " ";
+    string q = "Q" + to_string(e.queue);
+    string move = q + "->Q" + to_string(e.to_queue);
+    switch (e.type) {
+    case EVENT_ARRIVAL:    return text + (e.queue == -1 ? "arrive-complete" : "arrive " + q);
+    case EVENT_DISPATCH:   return text + (e.flags & EVENT_FIRST ? "start " : "resume ") + q;
+    case EVENT_PREEMPTION: return text + "preempt " + q;
+    case EVENT_DEMOTION:   return text + (e.to_queue != e.queue ? "demote " + move : "expire " + q);
+    case EVENT_AGING:      return text + "age " + move;
+    case EVENT_BOOST_RESET: return text + "boost " + move;
+    case EVENT_COMPLETION: return text + "complete " + q;
+    case EVENT_BLOCK:      return text + (e.to_queue != e.queue ? "block " + move : "block " + q) + 
+                                  " io=" + to_string(e.arg);
+    case EVENT_WAKE:       return text + "wake " + q;
+    }
+    return text + "event " + to_string(e.type);
+}
 
-class RR_Scheduler {
-private:
-    vector<Process> processes;
-    int time_quantum;
-    
-public:
-    RR_Scheduler(vector<Process>& procs, int tq) : processes(procs), time_quantum(tq) {}
+// Gantt chart rebuilt from the events: a bar starts at each dispatch and
+// ends when the process leaves the CPU or a boost moves it to another
+// queue. Adjacent bars of the same process and queue are merged, as in
+// the scheduler's own timeline.
+vector<TimelineSegment> rebuild_timeline(const vector<SchedEvent>& events) {
+    vector<TimelineSegment> timeline;
+    int running_pid = 0, running_queue = -1, running_start = 0;
     
-    Metrics run() {
-        deque<Process*> ready_queue;
-        int current_time = 0;
-        int completed = 0;
-        int total_busy_time = 0;
-        int context_switches = 0;
-        size_t next_arrival = 0;
-        Process* currently_running = nullptr;
-        int quantum_used = 0;
-        
-        sort(processes.begin(), processes.end(), 
-             [](const Process& a, const Process& b) { return a.arrival < b.arrival; });
-        
-        while (completed < processes.size()) {
-            while (next_arrival < processes.size() && processes[next_arrival].arrival <= current_time) {
-                ready_queue.push_back(&processes[next_arrival]);
-                next_arrival++;
-            }
-            
-            if (currently_running == nullptr || currently_running->remaining == 0) {
-                if (ready_queue.empty()) {
-                    current_time++;
-                    continue;
-                }
-                
-                currently_running = ready_queue.front();
-                ready_queue.pop_front();
-                quantum_used = 0;
-                
-                if (!currently_running->started) {
-                    currently_running->started = true;
-                    currently_running->start_time = current_time;
-                }
-                context_switches++;
+    auto add = [&timeline](int pid, int queue, int start, int end) {
+        if (end <= start) return;
+        if (!timeline.empty()) {
+            TimelineSegment& last = timeline.back();
+            if (last.pid == pid && last.queue == queue && last.start + last.length == start) {
+                last.length += end - start;
+                return;
             }
-            
-            currently_running->remaining--;
-            quantum_used++;
-            current_time++;
-            total_busy_time++;
-            
-            if (currently_running->remaining == 0) {
-                currently_running->completion = current_time;
-                completed++;
-                currently_running = nullptr;
+        }
+        timeline.push_back({pid, queue, start, end - start});
+    };
+    
+    for (auto& e : events) {
+        switch (e.type) {
+        case EVENT_DISPATCH:
+            running_pid = e.pid;
+            running_queue = e.queue;
+            running_start = e.time;
+            break;
+        case EVENT_PREEMPTION:
+        case EVENT_DEMOTION:
+        case EVENT_COMPLETION:
+        case EVENT_BLOCK:
+            if (e.pid == running_pid) {
+                add(running_pid, running_queue, running_start, e.time);
+                running_pid = 0;
             }
-            else if (quantum_used >= time_quantum) {
-                ready_queue.push_back(currently_running);
-                currently_running = nullptr;
+            break;
+        case EVENT_BOOST_RESET:
+            if ((e.flags & EVENT_RUNNING) && e.pid == running_pid) {
+                add(running_pid, running_queue, running_start, e.time);
+                running_queue = e.to_queue;
+                running_start = e.time;
             }
+            break;
+        case EVENT_IDLE:
+            add(0, -1, e.time, e.arg);
+            break;
         }
-        
-        Metrics m;
-        double total_tat = 0, total_wt = 0;
-        int last_completion = 0;
-        
-        for (auto& p : processes) {
-            total_tat += (p.completion - p.arrival);
-            total_wt += (p.completion - p.arrival - p.burst);
-            last_completion = max(last_completion, p.completion);
-        }
-        
-        m.avg_turnaround = total_tat / processes.size();
-        m.avg_waiting = total_wt / processes.size();
-        m.throughput = (double)processes.size() / last_completion;
-        m.cpu_util = 100.0 * total_busy_time / last_completion;
-        m.context_switches = context_switches;
-        
-        return m;
     }
-};
+    return timeline;
+}
 
-class FCFS_Scheduler {
-private:
-    vector<Process> processes;
+// Print per-process histories and the Gantt chart of a binary event log,
+// in a stable text form suitable for diffing runs
+int report_event_log(const string& filename) {
+    vector<SchedEvent> events;
+    string error;
+    if (!load_event_log(filename, events, error)) {
+        cerr << "Error: " << filename << ": " << error << "\n";
+        return 1;
+    }
     
-public:
-    FCFS_Scheduler(vector<Process>& procs) : processes(procs) {}
+    // Stable by pid: each process's events stay in time order
+    vector<size_t> order;
+    for (size_t i = 0; i < events.size(); i++) {
+        if (events[i].pid != 0) order.push_back(i);
+    }
+    stable_sort(order.begin(), order.end(),
+                [&events](size_t a, size_t b) { return events[a].pid < events[b].pid; });
     
-    Metrics run() {
-        sort(processes.begin(), processes.end(), 
-             [](const Process& a, const Process& b) { return a.arrival < b.arrival; });
-        
-        int current_time = 0;
-        int total_busy_time = 0;
-        int context_switches = 0;
-        
-        for (auto& p : processes) {
-            if (current_time < p.arrival) {
-                current_time = p.arrival;
-            }
-            
-            p.start_time = current_time;
-            p.started = true;
-            current_time += p.burst;
-            p.completion = current_time;
-            total_busy_time += p.burst;
-            context_switches++;
+    string text = "\nEvent log: " + filename + " (" + to_string(events.size()) + " events)\n";
+    text += "\nProcess Histories:\n";
+    for (size_t i = 0; i < order.size(); i++) {
+        const SchedEvent& e = events[order[i]];
+        bool first = (i == 0 || events[order[i - 1]].pid != e.pid);
+        text += first ? "P" + to_string(e.pid) + ": " : ", ";
+        text += describe_event(e);
+        if (i + 1 == order.size() || events[order[i + 1]].pid != e.pid) text += "\n";
+        if (text.size() >= (1 << 16)) {
+            cout.write(text.data(), text.size());
+            text.clear();
         }
-        
-        Metrics m;
-        double total_tat = 0, total_wt = 0;
-        int last_completion = 0;
-        
-        for (auto& p : processes) {
-            total_tat += (p.completion - p.arrival);
-            total_wt += (p.completion - p.arrival - p.burst);
-            last_completion = max(last_completion, p.completion);
+    }
+    
+    text += "\nGantt Chart:\n";
+    for (auto& seg : rebuild_timeline(events)) {
+        if (seg.pid == 0) {
+            text += "Idle\t" + to_string(seg.start) + "\t" + to_string(seg.start + seg.length) + "\n";
+        } else {
+            text += "P" + to_string(seg.pid) + "\tQ" + to_string(seg.queue) + "\t" +
+                    to_string(seg.start) + "\t" + to_string(seg.start + seg.length) + "\n";
+        }
+        if (text.size() >= (1 << 16)) {
+            cout.write(text.data(), text.size());
+            text.clear();
         }
-        
-        m.avg_turnaround = total_tat / processes.size();
-        m.avg_waiting = total_wt / processes.size();
-        m.throughput = (double)processes.size() / last_completion;
-        m.cpu_util = 100.0 * total_busy_time / last_completion;
-        m.context_switches = context_switches;
-        
-        return m;
     }
-};
+    cout.write(text.data(), text.size());
+    return 0;
+}
 
-class SJF_Scheduler {
-private:
-    vector<Process> processes;
+// ==================== BENCHMARK ====================
+// Synthetic workload, given as key=value arguments to --bench:
+//   jobs=N         number of processes (up to 10^8)
+//   seed=S         random seed; the same seed gives the same workload
+//   rate=R         Poisson arrivals, R processes per time unit on average
+//   burst=D        exp (exponential), pareto (heavy-tailed) or bimodal
+//   mean=M         mean burst for exp and pareto
+//   alpha=A        pareto shape (> 1; smaller is heavier)
+//   short=S long=L long_frac=F
+//                  bimodal: exponential bursts of mean L with probability F,
+//                  otherwise of mean S
+//   mix=W0:W1:...  relative weight of each initial priority (default equal)
+struct WorkloadSpec {
+    long long jobs;
+    uint64_t seed;
+    double rate;
+    string burst;
+    double mean;
+    double alpha;
+    double short_mean;
+    double long_mean;
+    double long_frac;
+    double interactive;     // Fraction of jobs alternating CPU and I/O
+    int cycles;             // CPU bursts per interactive job
+    double io_mean;
+    vector<double> mix;
     
-public:
-    SJF_Scheduler(vector<Process>& procs) : processes(procs) {}
+    WorkloadSpec() {
+        jobs = 100000;
+        seed = 1;
+        rate = 0.18;
+        burst = "exp";
+        mean = 5;
+        alpha = 1.5;
+        short_mean = 2;
+        long_mean = 40;
+        long_frac = 0.1;
+        interactive = 0;
+        cycles = 5;
+        io_mean = 10;
+    }
     
-    Metrics run() {
-        sort(processes.begin(), processes.end(), 
-             [](const Process& a, const Process& b) { return a.arrival < b.arrival; });
-        
-        int current_time = 0;
-        int completed = 0;
-        int total_busy_time = 0;
-        int context_switches = 0;
-        vector<bool> done(processes.size(), false);
-        
-        while (completed < processes.size()) {
-            int shortest = -1;
-            int min_burst = INT_MAX;
-            
-            for (size_t i = 0; i < processes.size(); i++) {
-                if (!done[i] && processes[i].arrival <= current_time && processes[i].burst < min_burst) {
-                    min_burst = processes[i].burst;
-                    shortest = i;
+    // Mean CPU time per job; interactive jobs draw each of their CPU
+    // bursts with mean short_mean
+    double mean_burst() const {
+        double batch = burst == "bimodal" ? (1 - long_frac) * short_mean + long_frac * long_mean : mean;
+        return (1 - interactive) * batch + interactive * cycles * short_mean;
+    }
+    
+    bool parse(const vector<string>& args, int num_queues, string& error) {
+        for (auto& arg : args) {
+            size_t eq = arg.find('=');
+            if (eq == string::npos) {
+                error = "expected key=value, got '" + arg + "'";
+                return false;
+            }
+            string key = arg.substr(0, eq);
+            string value = arg.substr(eq + 1);
+            istringstream in(value);
+            bool ok = true;
+            if (key == "jobs") ok = (bool)(in >> jobs);
+            else if (key == "seed") ok = (bool)(in >> seed);
+            else if (key == "rate") ok = (bool)(in >> rate);
+            else if (key == "burst") burst = value;
+            else if (key == "mean") ok = (bool)(in >> mean);
+            else if (key == "alpha") ok = (bool)(in >> alpha);
+            else if (key == "short") ok = (bool)(in >> short_mean);
+            else if (key == "long") ok = (bool)(in >> long_mean);
+            else if (key == "long_frac") ok = (bool)(in >> long_frac);
+            else if (key == "interactive") ok = (bool)(in >> interactive);
+            else if (key == "cycles") ok = (bool)(in >> cycles);
+            else if (key == "io") ok = (bool)(in >> io_mean);
+            else if (key == "mix") {
+                mix.clear();
+                double w;
+                char sep;
+                while (in >> w) {
+                    mix.push_back(w);
+                    if (!(in >> sep)) break;
+                    ok = ok && sep == ':';
                 }
+                ok = ok && !mix.empty();
+            } else {
+                error = "unknown key '" + key + "'";
+                return false;
             }
-            
-            if (shortest == -1) {
-                current_time++;
-                continue;
+            if (!ok) {
+                error = "bad value for " + key + ": '" + value + "'";
+                return false;
             }
-            
-            Process& p = processes[shortest];
-            p.start_time = current_time;
-            p.started = true;
-            current_time += p.burst;
-            p.completion = current_time;
-            total_busy_time += p.burst;
-            done[shortest] = true;
-            completed++;
-            context_switches++;
         }
         
-        Metrics m;
-        double total_tat = 0, total_wt = 0;
-        int last_completion = 0;
-        
-        for (auto& p : processes) {
-            total_tat += (p.completion - p.arrival);
-            total_wt += (p.completion - p.arrival - p.burst);
-            last_completion = max(last_completion, p.completion);
+        if (mix.empty()) mix.assign(num_queues, 1.0);
+        double total_weight = 0;
+        for (double w : mix) {
+            if (w < 0) total_weight = -1;
+            else if (total_weight >= 0) total_weight += w;
         }
         
-        m.avg_turnaround = total_tat / processes.size();
-        m.avg_waiting = total_wt / processes.size();
-        m.throughput = (double)processes.size() / last_completion;
-        m.cpu_util = 100.0 * total_busy_time / last_completion;
-        m.context_switches = context_switches;
-        
-        return m;
+        if (jobs < 1 || jobs > 100000000) error = "jobs must be between 1 and 10^8";
+        else if (rate <= 0) error = "rate must be positive";
+        else if (burst != "exp" && burst != "pareto" && burst != "bimodal") error = "burst must be exp, pareto or bimodal";
+        else if (mean < 1 || short_mean < 1 || long_mean < 1) error = "mean bursts must be at least 1";
+        else if (burst == "pareto" && alpha <= 1) error = "alpha must be greater than 1";
+        else if (long_frac < 0 || long_frac > 1) error = "long_frac must be between 0 and 1";
+        else if (interactive < 0 || interactive > 1) error = "interactive must be between 0 and 1";
+        else if (cycles < 1 || cycles > 1000) error = "cycles must be between 1 and 1000";
+        else if (io_mean < 1) error = "io must be at least 1";
+        else if (total_weight <= 0) error = "mix needs non-negative weights with a positive sum";
+        // Simulated time is 32-bit
+        else if (jobs * max(mean_burst(), 1 / rate) + interactive * (cycles - 1) * io_mean > INT_MAX / 4) error = "workload too long for 32-bit time";
+        return error.empty();
+    }
+    
+    string describe() const {
+        ostringstream out;
+        out << jobs << " jobs, seed " << seed << ", Poisson arrivals (rate " << rate << "/unit), ";
+        if (burst == "exp") out << "exponential bursts (mean " << mean << ")";
+        else if (burst == "pareto") out << "Pareto bursts (mean " << mean << ", alpha " << alpha << ")";
+        else out << "bimodal bursts (" << short_mean << " / " << long_mean << ", long " << long_frac << ")";
+        if (interactive > 0) {
+            out << ", interactive " << interactive << " (" << cycles << " CPU bursts of mean " << short_mean
+                << ", I/O mean " << io_mean << ")";
+        }
+        out << ", priority mix ";
+        for (size_t i = 0; i < mix.size(); i++) {
+            out << (i ? ":" : "") << mix[i];
+        }
+        return out.str();
     }
 };
 
-// ==================== COMPARATIVE ANALYSIS ====================
-void run_comparative_analysis(const vector<ProcessOriginal>& original_data, const Config& config) {
-    cout << "\n========================================\n";
-    cout << "COMPARATIVE ANALYSIS\n";
-    cout << "========================================\n\n";
-    cout << "Comparing MLFQ with other scheduling algorithms...\n\n";
+// Generates a workload on demand in arrival order, so even 10^8 jobs can
+// be streamed into MLFQ. Draws its own uniforms from mt19937_64, so a seed
+// gives the same workload with every standard library.
+class WorkloadGenerator : public ProcessSource {
+private:
+    static const int MAX_BURST = 1000000;
+    
+    WorkloadSpec spec;
+    mt19937_64 rng;
+    vector<double> mix_cumulative;
+    long long produced;
+    double clock;
+    deque<ProcessOriginal> lookahead;
     
-    // Run MLFQ
-    vector<Process> mlfq_procs;
-    for (size_t i = 0; i < original_data.size(); i++) {
-        mlfq_procs.emplace_back(original_data[i].pid, original_data[i].arrival, 
-                                original_data[i].burst, original_data[i].initial_priority);
+    double uniform() {
+        return (rng() >> 11) * (1.0 / 9007199254740992.0);
     }
-    MLFQ_Scheduler mlfq(mlfq_procs, config);
-    mlfq.run(false);
-    Metrics mlfq_metrics = mlfq.get_metrics();
     
-    // Run Round Robin
-    vector<Process> rr_procs;
-    for (size_t i = 0; i < original_data.size(); i++) {
-        rr_procs.emplace_back(original_data[i].pid, original_data[i].arrival, 
-                              original_data[i].burst, original_data[i].initial_priority);
+    double exponential(double mean) {
+        return -mean * log(1.0 - uniform());
     }
-    RR_Scheduler rr(rr_procs, 4);
-    Metrics rr_metrics = rr.run();
     
-    // Run FCFS
-    vector<Process> fcfs_procs;
-    for (size_t i = 0; i < original_data.size(); i++) {
-        fcfs_procs.emplace_back(original_data[i].pid, original_data[i].arrival, 
-                                original_data[i].burst, original_data[i].initial_priority);
+    int draw_burst() {
+        double x;
+        if (spec.burst == "pareto") {
+            double scale = spec.mean * (spec.alpha - 1) / spec.alpha;
+            x = scale / pow(1.0 - uniform(), 1.0 / spec.alpha);
+        } else if (spec.burst == "bimodal") {
+            double mean = uniform() < spec.long_frac ? spec.long_mean : spec.short_mean;
+            x = exponential(mean);
+        } else {
+            x = exponential(spec.mean);
+        }
+        return (int)max(1.0, min((double)MAX_BURST, round(x)));
     }
-    FCFS_Scheduler fcfs(fcfs_procs);
-    Metrics fcfs_metrics = fcfs.run();
     
-    // Run SJF
-    vector<Process> sjf_procs;
-    for (size_t i = 0; i < original_data.size(); i++) {
-        sjf_procs.emplace_back(original_data[i].pid, original_data[i].arrival, 
-                               original_data[i].burst, original_data[i].initial_priority);
+    int draw(double mean) {
+        return (int)max(1.0, min((double)MAX_BURST, round(exponential(mean))));
     }
-    SJF_Scheduler sjf(sjf_procs);
-    Metrics sjf_metrics = sjf.run();
     
-    // Display comparison table
-    cout << "\n========================================\n";
-    cout << "PERFORMANCE COMPARISON TABLE\n";
-    cout << "========================================\n\n";
+    // I/O and CPU bursts after the first, for an interactive job
+    BurstList draw_io_cycles() {
+        vector<int> bursts;
+        for (int i = 1; i < spec.cycles; i++) {
+            bursts.push_back(draw(spec.io_mean));
+            bursts.push_back(draw(spec.short_mean));
+        }
+        return BurstList(bursts);
+    }
     
-    cout << left << setw(15) << "Algorithm" 
-         << right << setw(12) << "Avg TAT" 
-         << setw(12) << "Avg WT" 
-         << setw(12) << "Throughput"
-         << setw(12) << "CPU Util%"
-         << setw(12) << "Ctx Switch" << "\n";
-    cout << string(73, '-') << "\n";
+    int draw_priority() {
+        double u = uniform() * mix_cumulative.back();
+        int level = upper_bound(mix_cumulative.begin(), mix_cumulative.end(), u) - mix_cumulative.begin();
+        return min(level, (int)mix_cumulative.size() - 1);
+    }
     
-    cout << left << setw(15) << "MLFQ"
-         << right << setw(12) << fixed << setprecision(2) << mlfq_metrics.avg_turnaround
-         << setw(12) << mlfq_metrics.avg_waiting
-         << setw(12) << setprecision(3) << mlfq_metrics.throughput
-         << setw(12) << setprecision(2) << mlfq_metrics.cpu_util
-         << setw(12) << mlfq_metrics.context_switches << "\n";
-    
-    cout << left << setw(15) << "Round Robin"
-         << right << setw(12) << rr_metrics.avg_turnaround
-         << setw(12) << rr_metrics.avg_waiting
-         << setw(12) << rr_metrics.throughput
-         << setw(12) << rr_metrics.cpu_util
-         << setw(12) << rr_metrics.context_switches << "\n";
-    
-    cout << left << setw(15) << "FCFS"
-         << right << setw(12) << fcfs_metrics.avg_turnaround
-         << setw(12) << fcfs_metrics.avg_waiting
-         << setw(12) << fcfs_metrics.throughput
-         << setw(12) << fcfs_metrics.cpu_util
-         << setw(12) << fcfs_metrics.context_switches << "\n";
-    
-    cout << left << setw(15) << "SJF"
-         << right << setw(12) << sjf_metrics.avg_turnaround
-         << setw(12) << sjf_metrics.avg_waiting
-         << setw(12) << sjf_metrics.throughput
-         << setw(12) << sjf_metrics.cpu_util
-         << setw(12) << sjf_metrics.context_switches << "\n";
+    bool generate_one() {
+        if (produced == spec.jobs) return false;
+        clock += exponential(1.0 / spec.rate);
+        // Only draw the job kind when asked to, so CPU-only workloads keep
+        // the same random stream as before
+        if (spec.interactive > 0 && uniform() < spec.interactive) {
+            int burst = draw(spec.short_mean);
+            BurstList more = draw_io_cycles();
+            int priority = draw_priority();
+            produced++;
+            lookahead.push_back(ProcessOriginal((int)produced, (int)clock, burst, priority, more));
+            return true;
+        }
+        int burst = draw_burst();
+        int priority = draw_priority();
+        produced++;
+        lookahead.push_back(ProcessOriginal((int)produced, (int)clock, burst, priority));
+        return true;
+    }
+
+public:
+    WorkloadGenerator(const WorkloadSpec& s) : spec(s), rng(s.seed), produced(0), clock(0) {
+        double sum = 0;
+        for (double w : spec.mix) {
+            sum += w;
+            mix_cumulative.push_back(sum);
+        }
+    }
     
-    cout << "\n========================================\n";
-    cout << "ANALYSIS\n";
-    cout << "========================================\n";
+    bool empty() override {
+        return lookahead.empty() && !generate_one();
+    }
+    
+    const ProcessOriginal& peek() override {
+        return lookahead.front();
+    }
     
-    vector<pair<string, double>> tat_vals;
-    tat_vals.push_back(make_pair("MLFQ", mlfq_metrics.avg_turnaround));
-    tat_vals.push_back(make_pair("RR", rr_metrics.avg_turnaround));
-    tat_vals.push_back(make_pair("FCFS", fcfs_metrics.avg_turnaround));
-    tat_vals.push_back(make_pair("SJF", sjf_metrics.avg_turnaround));
+    ProcessOriginal next() override {
+        ProcessOriginal p = move(lookahead.front());
+        lookahead.pop_front();
+        return p;
+    }
     
-    pair<string, double> best_tat = tat_vals[0];
-    for (size_t i = 1; i < tat_vals.size(); i++) {
-        if (tat_vals[i].second < best_tat.second) {
-            best_tat = tat_vals[i];
+    bool has_arrival_after(int t) override {
+        if (!lookahead.empty() && lookahead.back().arrival > t) return true;
+        while (generate_one()) {
+            if (lookahead.back().arrival > t) return true;
         }
+        return false;
+    }
+};
+
+// Peak resident set size in KB, 0 where unsupported. On Linux it is the
+// peak since the last reset_peak_rss(); elsewhere since the program started.
+long peak_rss_kb() {
+#if defined(__linux__)
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) return atol(line.c_str() + 6);
+    }
+    return 0;
+#elif defined(__APPLE__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024;
+#elif defined(__unix__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+#else
+    return 0;
+#endif
+}
+
+void reset_peak_rss() {
+#if defined(__linux__)
+    ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+#endif
+}
+
+struct BenchResult {
+    string name;
+    double seconds;
+    long long events;       // Arrivals + completions + dispatches
+    long rss_kb;
+    Metrics metrics;
+};
+
+// Larger workloads are not held in memory: MLFQ streams them from the
+// generator and the comparison schedulers, which need them whole, are skipped
+const long long BENCH_IN_MEMORY_LIMIT = 10000000;
+
+// Time one run of `scheduler`; the peak memory is since the last reset
+BenchResult time_scheduler(Scheduler& scheduler, long long jobs) {
+    auto start = chrono::steady_clock::now();
+    Metrics m = scheduler.run();
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    
+    BenchResult r;
+    r.name = scheduler.name();
+    r.seconds = elapsed.count();
+    r.events = 2 * jobs + m.context_switches;
+    r.rss_kb = peak_rss_kb();
+    r.metrics = m;
+    return r;
+}
+
+// Generate a synthetic workload, run every scheduler on it one at a time
+// and report engine speed and scheduling metrics. With several CPUs in
+// smp_options only MLFQ runs, on those CPUs.
+int run_benchmark(const vector<string>& args, const Config& config, const SMPOptions& smp_options) {
+    WorkloadSpec spec;
+    string error;
+    if (!spec.parse(args, config.num_queues, error)) {
+        cerr << "Error: --bench: " << error << "\n";
+        return 1;
     }
     
-    vector<pair<string, double>> wt_vals;
-    wt_vals.push_back(make_pair("MLFQ", mlfq_metrics.avg_waiting));
-    wt_vals.push_back(make_pair("RR", rr_metrics.avg_waiting));
-    wt_vals.push_back(make_pair("FCFS", fcfs_metrics.avg_waiting));
-    wt_vals.push_back(make_pair("SJF", sjf_metrics.avg_waiting));
+    cout << "\n========================================\n";
+    cout << "BENCHMARK\n";
+    cout << "========================================\n";
+    cout << "Workload: " << spec.describe() << "\n";
     
-    pair<string, double> best_wt = wt_vals[0];
-    for (size_t i = 1; i < wt_vals.size(); i++) {
-        if (wt_vals[i].second < best_wt.second) {
-            best_wt = wt_vals[i];
+    vector<BenchResult> results;
+    LatencyReport mlfq_latency;
+    WorkloadGenerator source(spec);
+    
+    int num_cpus = smp_options.num_cpus;
+    if (num_cpus > 0) {
+        reset_peak_rss();
+        SMP_Scheduler smp(source, config, num_cpus);
+        smp_options.apply(smp);
+        cout << "(" << num_cpus << " CPUs on " << smp.threads() << " threads: MLFQ-SMP streams "
+             << "the workload from the generator, comparison schedulers skipped)\n";
+        results.push_back(time_scheduler(smp, spec.jobs));
+        mlfq_latency = smp.get_latency();
+    } else if (spec.jobs <= BENCH_IN_MEMORY_LIMIT) {
+        vector<ProcessOriginal> workload;
+        workload.reserve(spec.jobs);
+        while (!source.empty()) {
+            workload.push_back(source.next());
+        }
+        
+        reset_peak_rss();
+        {
+            MLFQ_Scheduler mlfq(make_processes(workload), config);
+            results.push_back(time_scheduler(mlfq, spec.jobs));
+            mlfq_latency = mlfq.get_latency();
+        }
+        
+        vector<function<Scheduler*(const vector<Process>&)>> baselines = {
+            [](const vector<Process>& p) { return new RR_Scheduler(p, 4); },
+            [](const vector<Process>& p) { return new FCFS_Scheduler(p); },
+            [](const vector<Process>& p) { return new SJF_Scheduler(p); },
+            [](const vector<Process>& p) { return new SRTF_Scheduler(p); }
+        };
+        if (spec.interactive > 0) {
+            cout << "(Interactive jobs do I/O, which only MLFQ models: comparison schedulers skipped)\n";
+            baselines.clear();
+        }
+        for (auto& make : baselines) {
+            reset_peak_rss();
+            unique_ptr<Scheduler> scheduler(make(make_processes(workload)));
+            results.push_back(time_scheduler(*scheduler, spec.jobs));
         }
+    } else {
+        cout << "(More than " << BENCH_IN_MEMORY_LIMIT << " jobs: MLFQ streams the workload from "
+             << "the generator, comparison schedulers skipped)\n";
+        reset_peak_rss();
+        MLFQ_Scheduler mlfq(source, config);
+        results.push_back(time_scheduler(mlfq, spec.jobs));
+        mlfq_latency = mlfq.get_latency();
     }
     
-    cout << "\nBest Average Turnaround Time: " << best_tat.first << " (" << best_tat.second << ")\n";
-    cout << "Best Average Waiting Time: " << best_wt.first << " (" << best_wt.second << ")\n";
+    cout << "\n" << left << setw(15) << "Algorithm"
+         << right << setw(12) << "Wall (s)"
+         << setw(14) << "Events/s"
+         << setw(14) << "Peak RSS MB"
+         << setw(12) << "Avg TAT"
+         << setw(12) << "Avg WT"
+         << setw(12) << "Throughput"
+         << setw(12) << "CPU Util%"
+         << setw(12) << "Ctx Switch" << "\n";
+    cout << string(115, '-') << "\n";
+    for (auto& r : results) {
+        cout << left << setw(15) << r.name
+             << right << setw(12) << fixed << setprecision(3) << r.seconds
+             << setw(14) << setprecision(0) << r.events / max(r.seconds, 1e-9)
+             << setw(14) << setprecision(1) << r.rss_kb / 1024.0
+             << setw(12) << setprecision(2) << r.metrics.avg_turnaround
+             << setw(12) << r.metrics.avg_waiting
+             << setw(12) << setprecision(3) << r.metrics.throughput
+             << setw(12) << setprecision(2) << r.metrics.cpu_util
+             << setw(12) << r.metrics.context_switches << "\n";
+    }
     
-    // Save comparison
-    ofstream fout("comparison_results.txt");
-    fout << "Scheduling Algorithm Comparison\n";
-    fout << "================================\n\n";
-    fout << "Algorithm\tAvg TAT\tAvg WT\tThroughput\tCPU Util%\tContext Switches\n";
-    fout << "MLFQ\t" << mlfq_metrics.avg_turnaround << "\t" << mlfq_metrics.avg_waiting << "\t"
-         << mlfq_metrics.throughput << "\t" << mlfq_metrics.cpu_util << "\t" << mlfq_metrics.context_switches << "\n";
-    fout << "RR\t" << rr_metrics.avg_turnaround << "\t" << rr_metrics.avg_waiting << "\t"
-         << rr_metrics.throughput << "\t" << rr_metrics.cpu_util << "\t" << rr_metrics.context_switches << "\n";
-    fout << "FCFS\t" << fcfs_metrics.avg_turnaround << "\t" << fcfs_metrics.avg_waiting << "\t"
-         << fcfs_metrics.throughput << "\t" << fcfs_metrics.cpu_util << "\t" << fcfs_metrics.context_switches << "\n";
-    fout << "SJF\t" << sjf_metrics.avg_turnaround << "\t" << sjf_metrics.avg_waiting << "\t"
-         << sjf_metrics.throughput << "\t" << sjf_metrics.cpu_util << "\t" << sjf_metrics.context_switches << "\n";
+    cout << "\n";
+    if (num_cpus > 0) print_cpu_stats(cout, results[0].metrics);
+    cout << "MLFQ ";
+    mlfq_latency.print(cout);
+    
+    ofstream fout("bench_results.txt");
+    fout << "Benchmark Results\n";
+    fout << "=================\n\n";
+    fout << "Workload: " << spec.describe() << "\n\n";
+    fout << "Algorithm\tWall (s)\tEvents\tEvents/s\tPeak RSS (KB)\tAvg TAT\tAvg WT\tThroughput\tCPU Util%\tContext Switches\n";
+    for (auto& r : results) {
+        fout << r.name << "\t" << r.seconds << "\t" << r.events << "\t"
+             << r.events / max(r.seconds, 1e-9) << "\t" << r.rss_kb << "\t"
+             << r.metrics.avg_turnaround << "\t" << r.metrics.avg_waiting << "\t"
+             << r.metrics.throughput << "\t" << r.metrics.cpu_util << "\t"
+             << r.metrics.context_switches << "\n";
+    }
+    if (num_cpus > 0) {
+        fout << "\n";
+        print_cpu_stats(fout, results[0].metrics);
+    }
     fout.close();
     
-    cout << "\nComparison results saved to: comparison_results.txt\n";
+    cout << "Benchmark results saved to: bench_results.txt\n";
+    return 0;
 }
 
 // ==================== MAIN FUNCTION ====================
@@ -1021,8 +4141,51 @@ int main(int argc, char** argv) {
     cout << "   MULTILEVEL FEEDBACK QUEUE (MLFQ) SCHEDULER   \n";
     cout << "====================================================================\n";
     
+    if (argc >= 2 && string(argv[1]) == "--convert") {
+        if (argc < 4) {
+            cerr << "Usage: " << argv[0] << " --convert <input.txt> <output.mlfqb>\n";
+            return 1;
+        }
+        return convert_trace(argv[2], argv[3]);
+    }
+    
+    if (argc >= 2 && string(argv[1]) == "--read-events") {
+        if (argc < 3) {
+            cerr << "Usage: " << argv[0] << " --read-events <events.mlfqe>\n";
+            return 1;
+        }
+        return report_event_log(argv[2]);
+    }
+    
+    bool use_config = false;
+    bool streaming = false;
+    string sweep_file;
+    string event_file;
+    SMPOptions smp_options;
+    for (int i = 2; i < argc; i++) {
+        string flag = argv[i];
+        if (flag == "-c") use_config = true;
+        else if (flag == "-s") streaming = true;
+        else if (flag == "--sweep" && i + 1 < argc) sweep_file = argv[++i];
+        else if (flag == "--events" && i + 1 < argc) event_file = argv[++i];
+        else if ((flag == "--cpus" || flag == "--threads" || flag == "--balance") && i + 1 < argc) {
+            int n = atoi(argv[++i]);
+            if (n < 1) {
+                cerr << "Error: " << flag << " needs a positive number\n";
+                return 1;
+            }
+            if (flag == "--cpus") smp_options.num_cpus = n;
+            else if (flag == "--threads") smp_options.threads = n;
+            else smp_options.balance_interval = n;
+        }
+    }
+    if (smp_options.num_cpus > 0 && (!event_file.empty() || !sweep_file.empty())) {
+        cerr << "Error: --events and --sweep simulate a single CPU; drop --cpus\n";
+        return 1;
+    }
+    
     Config config;
-    if (argc >= 3 && string(argv[2]) == "-c") {
+    if (use_config) {
         if (config.load_from_file("config.txt")) {
             cout << "\nConfiguration loaded from config.txt\n";
         } else {
@@ -1037,6 +4200,24 @@ int main(int argc, char** argv) {
     
     string infile = (argc >= 2) ? argv[1] : "";
     
+    if (infile == "--bench") {
+        vector<string> bench_args;
+        for (int i = 2; i < argc; i++) {
+            string arg = argv[i];
+            if (arg == "--cpus" || arg == "--threads" || arg == "--balance") i++;
+            else if (arg != "-c") bench_args.push_back(arg);
+        }
+        return run_benchmark(bench_args, config, smp_options);
+    }
+    
+    if (streaming) {
+        if (infile.empty()) {
+            cerr << "Error: Streaming mode needs an input file\n";
+            return 1;
+        }
+        return run_streaming(infile, config, event_file, smp_options);
+    }
+    
     if (infile.empty()) {
         int N;
         cout << "\nEnter number of processes: ";
@@ -1049,19 +4230,11 @@ int main(int argc, char** argv) {
             original_data.push_back(ProcessOriginal(pid, a, b, prio));
         }
     } else {
-        ifstream fin(infile);
-        if (!fin) {
-            cerr << "Error: Cannot open file: " << infile << "\n";
+        string error;
+        if (!load_process_file(infile, original_data, error)) {
+            cerr << "Error: " << infile << ": " << error << "\n";
             return 1;
         }
-        int N;
-        fin >> N;
-        for (int i = 0; i < N; i++) {
-            int pid, a, b, prio;
-            fin >> pid >> a >> b >> prio;
-            original_data.push_back(ProcessOriginal(pid, a, b, prio));
-        }
-        fin.close();
         cout << "\nProcesses loaded from: " << infile << "\n";
     }
     
@@ -1070,21 +4243,43 @@ int main(int argc, char** argv) {
         return 1;
     }
     
-    // Create processes for MLFQ
-    vector<Process> processes;
-    for (size_t i = 0; i < original_data.size(); i++) {
-        processes.push_back(Process(original_data[i].pid, original_data[i].arrival, 
-                                    original_data[i].burst, original_data[i].initial_priority));
+    if (!sweep_file.empty()) {
+        return run_sweep(original_data, sweep_file);
+    }
+    
+    if (smp_options.num_cpus > 0) {
+        ProcessList workload(original_data);
+        SMP_Scheduler smp(workload, config, smp_options.num_cpus);
+        smp_options.apply(smp);
+        smp.run();
+        report_smp(smp, config);
+        
+        cout << "\n====================================================================\n";
+        cout << "                      Simulation Complete!                          \n";
+        cout << "====================================================================\n\n";
+        return 0;
     }
     
+    // Create processes for MLFQ
+    vector<Process> processes = make_processes(original_data);
+    
     sort(processes.begin(), processes.end(), 
          [](const Process& a, const Process& b) {
              return a.arrival < b.arrival || (a.arrival == b.arrival && a.pid < b.pid);
          });
     
     // Run MLFQ Scheduler
+    EventLogWriter event_log;
+    if (!event_file.empty() && !event_log.open(event_file)) {
+        cerr << "Error: Cannot write file: " << event_file << "\n";
+        return 1;
+    }
     MLFQ_Scheduler scheduler(processes, config);
+    if (!event_file.empty()) scheduler.set_event_log(&event_log);
     scheduler.run(true);
+    if (!event_file.empty() && !finish_event_log(event_log, event_file)) {
+        return 1;
+    }
     
     // Run comparative analysis
     cout << "\nWould you like to run comparative analysis? (y/n): ";